@@ -0,0 +1,72 @@
+/// Measures how graph rendering scales with the number of render
+/// threads. Builds a wide graph of independent gain chains that fan in
+/// to a single output and renders it with 1, 2, 4 … N threads.
+///
+/// Run from the directory holding the native library:
+///
+///   dart run benchmark/parallel_render.dart [chains] [depth] [threads]
+
+import 'dart:io';
+import 'dart:typed_data';
+import 'package:dart_vst_graph/dart_vst_graph.dart';
+
+const _blockSize = 512;
+const _warmupBlocks = 200;
+const _blocks = 2000;
+
+void main(List<String> args) {
+  final chains = args.isNotEmpty ? int.parse(args[0]) : 64;
+  final depth = args.length > 1 ? int.parse(args[1]) : 16;
+  final maxThreads = args.length > 2 ? int.parse(args[2]) : Platform.numberOfProcessors;
+  final libName = Platform.isWindows
+      ? 'dart_vst_host.dll'
+      : Platform.isMacOS
+          ? 'libdart_vst_host.dylib'
+          : 'libdart_vst_host.so';
+  final libPath = Directory.current.path + Platform.pathSeparator + libName;
+
+  stdout.writeln('$chains chains x $depth nodes, $_blockSize frames per block');
+  double? baseline;
+  for (var threads = 1; threads <= maxThreads; threads *= 2) {
+    final us = _run(libPath, chains, depth, threads);
+    baseline ??= us;
+    stdout.writeln('${threads.toString().padLeft(3)} threads: '
+        '${us.toStringAsFixed(1).padLeft(9)} us/block  '
+        'speedup ${(baseline / us).toStringAsFixed(2)}x');
+  }
+}
+
+/// Average wall time in microseconds to render one block.
+double _run(String libPath, int chains, int depth, int threads) {
+  final graph = VstGraph(sampleRate: 48000, maxBlock: _blockSize, dylibPath: libPath);
+  try {
+    if (!graph.setThreadCount(threads)) throw StateError('setThreadCount($threads) failed');
+    final input = graph.addSplit();
+    final output = graph.addSplit();
+    for (var c = 0; c < chains; c++) {
+      var prev = input;
+      for (var d = 0; d < depth; d++) {
+        final gain = graph.addGain(-0.1);
+        graph.connect(prev, gain);
+        prev = gain;
+      }
+      graph.connect(prev, output);
+    }
+    graph.setIO(inputNode: input, outputNode: output);
+
+    final inL = Float32List(_blockSize)..fillRange(0, _blockSize, 0.5);
+    final inR = Float32List(_blockSize)..fillRange(0, _blockSize, 0.5);
+    final outL = Float32List(_blockSize);
+    final outR = Float32List(_blockSize);
+    for (var i = 0; i < _warmupBlocks; i++) {
+      graph.process(inL, inR, outL, outR);
+    }
+    final sw = Stopwatch()..start();
+    for (var i = 0; i < _blocks; i++) {
+      graph.process(inL, inR, outL, outR);
+    }
+    return sw.elapsedMicroseconds / _blocks;
+  } finally {
+    graph.dispose();
+  }
+}
@@ -12,18 +12,33 @@ typedef _GraphCreateC = Pointer<Void> Function(Double, Int32);
 typedef _GraphDestroyC = Void Function(Pointer<Void>);
 typedef _GraphClearC = Int32 Function(Pointer<Void>);
 typedef _AddVstC = Int32 Function(Pointer<Void>, Pointer<Utf8>, Pointer<Utf8>, Pointer<Int32>);
+typedef _AddVstAsyncC = Int32 Function(Pointer<Void>, Pointer<Utf8>, Pointer<Utf8>);
+typedef _PollVstC = Int32 Function(Pointer<Void>, Int32, Pointer<Int32>);
+typedef _LoadProgressC = Int32 Function(Pointer<Void>, Pointer<Int32>, Pointer<Int32>);
 typedef _AddMixerC = Int32 Function(Pointer<Void>, Int32, Pointer<Int32>);
 typedef _AddSplitC = Int32 Function(Pointer<Void>, Pointer<Int32>);
 typedef _AddGainC = Int32 Function(Pointer<Void>, Float, Pointer<Int32>);
+typedef _RemoveNodeC = Int32 Function(Pointer<Void>, Int32);
 typedef _ConnC = Int32 Function(Pointer<Void>, Int32, Int32, Int32, Int32);
 typedef _SetIO = Int32 Function(Pointer<Void>, Int32, Int32);
 typedef _NoteC = Int32 Function(Pointer<Void>, Int32, Int32, Int32, Float);
+typedef _NoteAtC = Int32 Function(Pointer<Void>, Int32, Int32, Int32, Int32, Float);
 typedef _ParamCountC = Int32 Function(Pointer<Void>, Int32);
 typedef _ParamInfoC = Int32 Function(Pointer<Void>, Int32, Int32, Pointer<Int32>, Pointer<Utf8>, Int32, Pointer<Utf8>, Int32);
 typedef _GetParamC = Float Function(Pointer<Void>, Int32, Int32);
 typedef _SetParamC = Int32 Function(Pointer<Void>, Int32, Int32, Float);
+typedef _SetParamAtC = Int32 Function(Pointer<Void>, Int32, Int32, Int32, Float);
 typedef _LatencyC = Int32 Function(Pointer<Void>);
+typedef _IsSleepingC = Int32 Function(Pointer<Void>, Int32);
+typedef _ThreadCountC = Int32 Function(Pointer<Void>, Int32);
+typedef _BlockQuantumC = Int32 Function(Pointer<Void>, Int32);
 typedef _ProcessC = Int32 Function(Pointer<Void>, Pointer<Float>, Pointer<Float>, Pointer<Float>, Pointer<Float>, Int32);
+typedef _ProcessF64C = Int32 Function(Pointer<Void>, Pointer<Double>, Pointer<Double>, Pointer<Double>, Pointer<Double>, Int32);
+typedef _DoublePrecisionC = Int32 Function(Pointer<Void>, Int32);
+typedef _AllocCountC = Int64 Function();
+typedef _BufferCountC = Int32 Function(Pointer<Void>);
+typedef _AddDelayC = Int32 Function(Pointer<Void>, Int32, Pointer<Int32>);
+typedef _RenderOfflineC = Int32 Function(Pointer<Void>, Pointer<Float>, Pointer<Float>, Pointer<Float>, Pointer<Float>, Int64, Pointer<Double>);
 
 class GraphBindings {
   final DynamicLibrary lib;
@@ -38,6 +53,12 @@ class GraphBindings {
 
   late final int Function(Pointer<Void>, Pointer<Utf8>, Pointer<Utf8>, Pointer<Int32>) addVst =
       lib.lookupFunction<_AddVstC, int Function(Pointer<Void>, Pointer<Utf8>, Pointer<Utf8>, Pointer<Int32>)>('dvh_graph_add_vst');
+  late final int Function(Pointer<Void>, Pointer<Utf8>, Pointer<Utf8>) addVstAsync =
+      lib.lookupFunction<_AddVstAsyncC, int Function(Pointer<Void>, Pointer<Utf8>, Pointer<Utf8>)>('dvh_graph_add_vst_async');
+  late final int Function(Pointer<Void>, int, Pointer<Int32>) pollVst =
+      lib.lookupFunction<_PollVstC, int Function(Pointer<Void>, int, Pointer<Int32>)>('dvh_graph_poll_vst');
+  late final int Function(Pointer<Void>, Pointer<Int32>, Pointer<Int32>) loadProgress =
+      lib.lookupFunction<_LoadProgressC, int Function(Pointer<Void>, Pointer<Int32>, Pointer<Int32>)>('dvh_graph_load_progress');
   late final int Function(Pointer<Void>, int, Pointer<Int32>) addMixer =
       lib.lookupFunction<_AddMixerC, int Function(Pointer<Void>, int, Pointer<Int32>)>('dvh_graph_add_mixer');
   late final int Function(Pointer<Void>, Pointer<Int32>) addSplit =
@@ -45,6 +66,9 @@ class GraphBindings {
   late final int Function(Pointer<Void>, double, Pointer<Int32>) addGain =
       lib.lookupFunction<_AddGainC, int Function(Pointer<Void>, double, Pointer<Int32>)>('dvh_graph_add_gain');
 
+  late final int Function(Pointer<Void>, int) removeNode =
+      lib.lookupFunction<_RemoveNodeC, int Function(Pointer<Void>, int)>('dvh_graph_remove_node');
+
   late final int Function(Pointer<Void>, int, int, int, int) connect =
       lib.lookupFunction<_ConnC, int Function(Pointer<Void>, int, int, int, int)>('dvh_graph_connect');
   late final int Function(Pointer<Void>, int, int, int, int) disconnect =
@@ -56,6 +80,10 @@ class GraphBindings {
       lib.lookupFunction<_NoteC, int Function(Pointer<Void>, int, int, int, double)>('dvh_graph_note_on');
   late final int Function(Pointer<Void>, int, int, int, double) noteOff =
       lib.lookupFunction<_NoteC, int Function(Pointer<Void>, int, int, int, double)>('dvh_graph_note_off');
+  late final int Function(Pointer<Void>, int, int, int, int, double) noteOnAt =
+      lib.lookupFunction<_NoteAtC, int Function(Pointer<Void>, int, int, int, int, double)>('dvh_graph_note_on_at');
+  late final int Function(Pointer<Void>, int, int, int, int, double) noteOffAt =
+      lib.lookupFunction<_NoteAtC, int Function(Pointer<Void>, int, int, int, int, double)>('dvh_graph_note_off_at');
 
   late final int Function(Pointer<Void>, int) paramCount =
       lib.lookupFunction<_ParamCountC, int Function(Pointer<Void>, int)>('dvh_graph_param_count');
@@ -66,11 +94,31 @@ class GraphBindings {
       lib.lookupFunction<_GetParamC, double Function(Pointer<Void>, int, int)>('dvh_graph_get_param');
   late final int Function(Pointer<Void>, int, int, double) setParam =
       lib.lookupFunction<_SetParamC, int Function(Pointer<Void>, int, int, double)>('dvh_graph_set_param');
+  late final int Function(Pointer<Void>, int, int, int, double) setParamAt =
+      lib.lookupFunction<_SetParamAtC, int Function(Pointer<Void>, int, int, int, double)>('dvh_graph_set_param_at');
 
+  late final int Function(Pointer<Void>, int) setThreadCount =
+      lib.lookupFunction<_ThreadCountC, int Function(Pointer<Void>, int)>('dvh_graph_set_thread_count');
+  late final int Function(Pointer<Void>, int) setBlockQuantum =
+      lib.lookupFunction<_BlockQuantumC, int Function(Pointer<Void>, int)>('dvh_graph_set_block_quantum');
+  late final int Function(Pointer<Void>, int) isSleeping =
+      lib.lookupFunction<_IsSleepingC, int Function(Pointer<Void>, int)>('dvh_graph_is_sleeping');
   late final int Function(Pointer<Void>) latency =
       lib.lookupFunction<_LatencyC, int Function(Pointer<Void>)>('dvh_graph_latency');
   late final int Function(Pointer<Void>, Pointer<Float>, Pointer<Float>, Pointer<Float>, Pointer<Float>, int) process =
       lib.lookupFunction<_ProcessC, int Function(Pointer<Void>, Pointer<Float>, Pointer<Float>, Pointer<Float>, Pointer<Float>, int)>('dvh_graph_process_stereo');
+  late final int Function(Pointer<Void>, Pointer<Double>, Pointer<Double>, Pointer<Double>, Pointer<Double>, int) processF64 =
+      lib.lookupFunction<_ProcessF64C, int Function(Pointer<Void>, Pointer<Double>, Pointer<Double>, Pointer<Double>, Pointer<Double>, int)>('dvh_graph_process_stereo_f64');
+  late final int Function(Pointer<Void>, int) setDoublePrecision =
+      lib.lookupFunction<_DoublePrecisionC, int Function(Pointer<Void>, int)>('dvh_graph_set_double_precision');
+  late final int Function(Pointer<Void>, Pointer<Float>, Pointer<Float>, Pointer<Float>, Pointer<Float>, int, Pointer<Double>) renderOffline =
+      lib.lookupFunction<_RenderOfflineC, int Function(Pointer<Void>, Pointer<Float>, Pointer<Float>, Pointer<Float>, Pointer<Float>, int, Pointer<Double>)>('dvh_graph_render_offline');
+  late final int Function(Pointer<Void>) debugBufferCount =
+      lib.lookupFunction<_BufferCountC, int Function(Pointer<Void>)>('dvh_graph_debug_buffer_count');
+  late final int Function(Pointer<Void>, int, Pointer<Int32>) debugAddDelay =
+      lib.lookupFunction<_AddDelayC, int Function(Pointer<Void>, int, Pointer<Int32>)>('dvh_graph_debug_add_delay');
+  late final int Function() debugAllocCount =
+      lib.lookupFunction<_AllocCountC, int Function()>('dvh_graph_debug_alloc_count');
 }
 
 /// Helper to load the native library. See dart_vst_host.loadDvh()
@@ -115,6 +163,60 @@ class VstGraph {
     }
   }
 
+  /// Start loading a VST3 plug‑in on a background thread and return
+  /// a request ID for [pollVst]. Several loads run in parallel and
+  /// audio keeps processing while they do. Node IDs are reserved in
+  /// request order.
+  int addVstAsync(String path, {String? classUid}) {
+    final p = path.toNativeUtf8();
+    final u = classUid == null ? nullptr : classUid.toNativeUtf8();
+    try {
+      final request = _b.addVstAsync(handle, p, u);
+      if (request == 0) throw StateError('addVstAsync failed');
+      return request;
+    } finally {
+      malloc.free(p);
+      if (u != nullptr) malloc.free(u);
+    }
+  }
+
+  /// Node ID of a finished [addVstAsync] request, or null while it is
+  /// still loading. Throws if the plug‑in failed to load.
+  int? pollVst(int request) {
+    final id = malloc<Int32>();
+    try {
+      final status = _b.pollVst(handle, request, id);
+      if (status < 0) throw StateError('addVstAsync request $request failed');
+      return status == 0 ? null : id.value;
+    } finally {
+      malloc.free(id);
+    }
+  }
+
+  /// Load a VST3 plug‑in without blocking the isolate. Completes with
+  /// the node ID once the plug‑in is attached to the graph.
+  Future<int> loadVst(String path, {String? classUid, Duration pollInterval = const Duration(milliseconds: 10)}) async {
+    final request = addVstAsync(path, classUid: classUid);
+    for (;;) {
+      final id = pollVst(request);
+      if (id != null) return id;
+      await Future<void>.delayed(pollInterval);
+    }
+  }
+
+  /// Progress of background loads since the loader was last idle.
+  ({int done, int total}) loadProgress() {
+    final done = malloc<Int32>();
+    final total = malloc<Int32>();
+    try {
+      _b.loadProgress(handle, done, total);
+      return (done: done.value, total: total.value);
+    } finally {
+      malloc.free(done);
+      malloc.free(total);
+    }
+  }
+
   /// Add a mixer with [inputs] stereo buses. Returns the node ID.
   int addMixer(int inputs) {
     final id = malloc<Int32>();
@@ -146,20 +248,127 @@ class VstGraph {
     }
   }
 
-  /// Connect source node [src] to destination [dst]. Only a single
-  /// stereo bus per node is supported currently. Returns true on
+  /// Remove node [id] and all of its connections. Safe to call while
+  /// audio is being processed on another thread. Returns true on
   /// success.
-  bool connect(int src, int dst) => _b.connect(handle, src, 0, dst, 0) == 1;
+  bool removeNode(int id) => _b.removeNode(handle, id) == 1;
+
+  /// Connect output bus [srcBus] of node [src] to input bus [dstBus]
+  /// of node [dst]. Several sources connected to the same input bus
+  /// are summed; mixers expose one input bus per input. Returns true
+  /// on success and false if an index is invalid, the connection
+  /// already exists or it would create a cycle.
+  bool connect(int src, int dst, {int srcBus = 0, int dstBus = 0}) =>
+      _b.connect(handle, src, srcBus, dst, dstBus) == 1;
+
+  /// Remove a connection previously made with [connect]. Returns true
+  /// on success.
+  bool disconnect(int src, int dst, {int srcBus = 0, int dstBus = 0}) =>
+      _b.disconnect(handle, src, srcBus, dst, dstBus) == 1;
 
   /// Set which nodes serve as the graph’s input and output. Returns
   /// true on success.
   bool setIO({required int inputNode, required int outputNode}) => _b.setIO(handle, inputNode, outputNode) == 1;
 
-  /// Set a parameter on a node. Returns true on success.
-  bool setParam(int node, int paramId, double v) => _b.setParam(handle, node, paramId, v) == 1;
+  /// Set a parameter on a node. The change takes effect [sampleOffset]
+  /// frames into the next processed block. Returns true on success.
+  bool setParam(int node, int paramId, double v, {int sampleOffset = 0}) =>
+      _b.setParamAt(handle, node, paramId, sampleOffset, v) == 1;
+
+  /// Send a note on to [node], or to every node when [node] is ‑1,
+  /// [sampleOffset] frames into the next processed block.
+  bool noteOn(int node, int channel, int note, double velocity, {int sampleOffset = 0}) =>
+      _b.noteOnAt(handle, node, sampleOffset, channel, note, velocity) == 1;
+
+  /// Send a note off to [node], or to every node when [node] is ‑1.
+  bool noteOff(int node, int channel, int note, double velocity, {int sampleOffset = 0}) =>
+      _b.noteOffAt(handle, node, sampleOffset, channel, note, velocity) == 1;
+
+  /// Whether [node] is asleep: its input has been silent for longer
+  /// than its tail and its output has died away, so it is skipped until
+  /// its input turns non‑silent or it receives a note or parameter
+  /// change.
+  bool isSleeping(int node) => _b.isSleeping(handle, node) == 1;
+
+  /// Latency of the graph in samples: the longest plug‑in latency path
+  /// from the input node to the output node. Shorter parallel paths
+  /// are delayed to match.
+  int latency() => _b.latency(handle);
+
+  /// Render in internal blocks of exactly [frames] samples whatever
+  /// block sizes are passed to [process], or disable with 0. Adds
+  /// [frames] to [latency]. Returns true on success.
+  bool setBlockQuantum(int frames) => _b.setBlockQuantum(handle, frames) == 1;
+
+  /// Render in 64‑bit (true) or 32‑bit (false) precision. Plug‑ins
+  /// that cannot process 64‑bit samples are converted at their own
+  /// inputs and outputs. Returns true on success.
+  bool setDoublePrecision(bool enable) => _b.setDoublePrecision(handle, enable ? 1 : 0) == 1;
+
+  /// Render each block on [threads] threads, including the caller's.
+  /// Independent nodes then run concurrently; the output is identical
+  /// to rendering on one thread. Returns true on success.
+  bool setThreadCount(int threads) => _b.setThreadCount(handle, threads) == 1;
+
+  /// Number of heap allocations made inside the native process call
+  /// so far, or ‑1 when the library was built without
+  /// DVH_GRAPH_TRACK_ALLOCATIONS.
+  int debugAllocationCount() => _b.debugAllocCount();
+
+  /// Number of stereo buffers the graph renders with. Buffers are
+  /// reused along the schedule, so this follows the width of the graph
+  /// rather than its number of nodes.
+  int debugBufferCount() => _b.debugBufferCount(handle);
+
+  /// Add a node that delays its input by [frames] samples and reports
+  /// that as its latency, standing in for a latent plug‑in in tests.
+  /// Returns the node id.
+  int debugAddDelay(int frames) {
+    final id = malloc<Int32>();
+    try {
+      if (_b.debugAddDelay(handle, frames, id) != 1) throw StateError('debugAddDelay failed');
+      return id.value;
+    } finally {
+      malloc.free(id);
+    }
+  }
+
+  /// Bounce a whole buffer through the graph as fast as the CPU allows.
+  /// Plug‑ins run in offline mode for the duration of the render and
+  /// the audio is processed in maxBlock slices. Pass null inputs to
+  /// render silence through the graph (e.g. instruments). Returns the
+  /// samples per second achieved; throws StateError on failure.
+  double renderOffline(Float32List? inL, Float32List? inR, Float32List outL, Float32List outR) {
+    final n = outL.length;
+    if (outR.length != n || (inL != null && inL.length != n) || (inR != null && inR.length != n)) {
+      throw ArgumentError('Buffers must have same length');
+    }
+    final pInL = inL == null ? nullptr : malloc<Float>(n);
+    final pInR = inR == null ? nullptr : malloc<Float>(n);
+    final pOutL = malloc<Float>(n);
+    final pOutR = malloc<Float>(n);
+    final sps = malloc<Double>();
+    try {
+      if (inL != null) pInL.asTypedList(n).setAll(0, inL);
+      if (inR != null) pInR.asTypedList(n).setAll(0, inR);
+      if (_b.renderOffline(handle, pInL, pInR, pOutL, pOutR, n, sps) != 1) {
+        throw StateError('renderOffline failed');
+      }
+      outL.setAll(0, pOutL.asTypedList(n));
+      outR.setAll(0, pOutR.asTypedList(n));
+      return sps.value;
+    } finally {
+      if (pInL != nullptr) malloc.free(pInL);
+      if (pInR != nullptr) malloc.free(pInR);
+      malloc.free(pOutL);
+      malloc.free(pOutR);
+      malloc.free(sps);
+    }
+  }
 
   /// Process a block of audio. The length of the output buffers must
-  /// match the input length. This method is primarily intended for
+  /// match the input length; any length is accepted and blocks longer
+  /// than maxBlock are split internally. This method is primarily intended for
   /// testing; real‑time processing in a plug‑in should use the native
   /// graph directly. Returns true on success.
   bool process(Float32List inL, Float32List inR, Float32List outL, Float32List outR) {
@@ -186,4 +395,31 @@ class VstGraph {
       malloc.free(pOutR);
     }
   }
-}
\ No newline at end of file
+
+  /// 64‑bit variant of [process]. Works in either precision; best used
+  /// after [setDoublePrecision].
+  bool processF64(Float64List inL, Float64List inR, Float64List outL, Float64List outR) {
+    if (inL.length != inR.length || inL.length != outL.length || inL.length != outR.length) {
+      throw ArgumentError('Buffers must have same length');
+    }
+    final n = inL.length;
+    final pInL = malloc<Double>(n);
+    final pInR = malloc<Double>(n);
+    final pOutL = malloc<Double>(n);
+    final pOutR = malloc<Double>(n);
+    try {
+      pInL.asTypedList(n).setAll(0, inL);
+      pInR.asTypedList(n).setAll(0, inR);
+      final ok = _b.processF64(handle, pInL, pInR, pOutL, pOutR, n) == 1;
+      if (!ok) return false;
+      outL.setAll(0, pOutL.asTypedList(n));
+      outR.setAll(0, pOutR.asTypedList(n));
+      return true;
+    } finally {
+      malloc.free(pInL);
+      malloc.free(pInR);
+      malloc.free(pOutL);
+      malloc.free(pOutR);
+    }
+  }
+}
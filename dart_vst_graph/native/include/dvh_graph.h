@@ -44,6 +44,13 @@ typedef struct {
   int32_t playing; // 0 = stopped, 1 = playing
 } DVH_Transport;
 
+// Threading: graph edits (adding, removing and connecting nodes) may
+// be made from any non‑audio thread while another thread is calling
+// dvh_graph_process_stereo(). Each edit publishes a new immutable
+// render plan which the audio thread picks up at the next block
+// boundary without taking a lock. Note, parameter and query calls are
+// lock free and may be made from the audio thread.
+
 // Create a new graph at the specified sample rate and maximum block
 // size. The graph owns its own internal host used for VST loading
 // (shared with other graphs). Returns a handle to the graph or
@@ -69,8 +76,33 @@ DVH_API int32_t dvh_graph_add_vst(DVH_Graph g,
                                   const char* class_uid_or_null,
                                   int32_t* out_node_id);
 
+// Asynchronous variant of dvh_graph_add_vst(). Queues the plugin to be
+// loaded and resumed on a background thread and returns a request ID
+// (> 0), or 0 on invalid arguments. Loads run in parallel on up to one
+// thread per core. Each request reserves its node ID immediately, so IDs
+// follow request order regardless of which load finishes first. The node
+// is attached to the graph in a single plan swap once loaded; processing
+// continues undisturbed meanwhile. Loads pending when the graph is cleared
+// are discarded and report DVH_LOAD_FAILED.
+DVH_API int32_t dvh_graph_add_vst_async(DVH_Graph g,
+                                        const char* module_path_utf8,
+                                        const char* class_uid_or_null);
+
+enum { DVH_LOAD_FAILED = -1, DVH_LOAD_PENDING = 0, DVH_LOAD_DONE = 1 };
+
+// Status of a request from dvh_graph_add_vst_async(). On DVH_LOAD_DONE the
+// node ID is written to out_node_id. Unknown requests report
+// DVH_LOAD_FAILED.
+DVH_API int32_t dvh_graph_poll_vst(DVH_Graph g, int32_t request, int32_t* out_node_id);
+
+// Progress of asynchronous loads. Writes the number of finished (loaded or
+// failed) and requested loads since the loader was last idle, and returns
+// the number still pending.
+DVH_API int32_t dvh_graph_load_progress(DVH_Graph g, int32_t* done, int32_t* total);
+
 // Add a mixer node with the given number of inputs. Each input
-// represents a stereo bus. The mixer sums all connected inputs with
+// represents a stereo bus addressed by dst_bus in
+// dvh_graph_connect(). The mixer sums all connected inputs with
 // per‑input gains (initially 0dB) and outputs a single stereo bus.
 // Returns 1 on success and writes the new node ID to out_node_id.
 DVH_API int32_t dvh_graph_add_mixer(DVH_Graph g, int32_t num_inputs, int32_t* out_node_id);
@@ -84,16 +116,28 @@ DVH_API int32_t dvh_graph_add_split(DVH_Graph g, int32_t* out_node_id);
 // mapped from ‑60dB (0.0) to 0dB (1.0). Returns 1 on success.
 DVH_API int32_t dvh_graph_add_gain(DVH_Graph g, float gain_db, int32_t* out_node_id);
 
-// Connect the output of src_node to the input of dst_node. The bus
-// indices are reserved for future multi‑bus support and must be zero
-// for now. Returns 1 on success.
+// Remove a node and all of its connections. The node stops being
+// processed from the next block and is destroyed once the audio
+// thread no longer references it. Node IDs are not reused. Returns 1
+// on success.
+DVH_API int32_t dvh_graph_remove_node(DVH_Graph g, int32_t node_id);
+
+// Connect output bus src_bus of src_node to input bus dst_bus of
+// dst_node. A source may feed any number of destinations and several
+// sources may feed the same input bus, in which case they are summed.
+// Mixer nodes expose one input bus per input; all other nodes have a
+// single input and output bus (index 0). The graph is re‑sorted
+// topologically after every edit so nodes always run after their
+// sources. Returns 1 on success and 0 if a node or bus index is
+// invalid, the connection already exists or it would create a cycle,
+// in which case the graph is left unchanged.
 DVH_API int32_t dvh_graph_connect(DVH_Graph g,
                                   int32_t src_node, int32_t src_bus,
                                   int32_t dst_node, int32_t dst_bus);
 
 // Disconnect the output of src_node from the input of dst_node. The
 // bus indices must match a previous call to dvh_graph_connect().
-// Returns 1 on success.
+// Returns 1 on success and 0 if no such connection exists.
 DVH_API int32_t dvh_graph_disconnect(DVH_Graph g,
                                      int32_t src_node, int32_t src_bus,
                                      int32_t dst_node, int32_t dst_bus);
@@ -108,6 +152,13 @@ DVH_API int32_t dvh_graph_set_io_nodes(DVH_Graph g, int32_t input_node_or_minus1
 DVH_API int32_t dvh_graph_note_on(DVH_Graph g, int32_t node_or_minus1, int32_t ch, int32_t note, float vel);
 DVH_API int32_t dvh_graph_note_off(DVH_Graph g, int32_t node_or_minus1, int32_t ch, int32_t note, float vel);
 
+// Sample accurate variants of the note functions. sample_offset is
+// the position of the event relative to the start of the next block
+// passed to dvh_graph_process_stereo(); events past the end of that
+// block are held until the block they fall in.
+DVH_API int32_t dvh_graph_note_on_at(DVH_Graph g, int32_t node_or_minus1, int32_t sample_offset, int32_t ch, int32_t note, float vel);
+DVH_API int32_t dvh_graph_note_off_at(DVH_Graph g, int32_t node_or_minus1, int32_t sample_offset, int32_t ch, int32_t note, float vel);
+
 // Query the number of parameters available on a node. Returns zero if
 // the node has no parameters or an invalid ID is supplied.
 DVH_API int32_t dvh_graph_param_count(DVH_Graph g, int32_t node_id);
@@ -127,23 +178,139 @@ DVH_API int32_t dvh_graph_param_info(DVH_Graph g, int32_t node_id, int32_t index
 DVH_API float   dvh_graph_get_param(DVH_Graph g, int32_t node_id, int32_t param_id);
 DVH_API int32_t dvh_graph_set_param(DVH_Graph g, int32_t node_id, int32_t param_id, float normalized);
 
+// Set a parameter at sample_offset frames into the next processed
+// block. Several points for the same parameter within one block form
+// an automation curve and are all forwarded to the node, so timing is
+// exact regardless of block size. Returns 1 on success.
+DVH_API int32_t dvh_graph_set_param_at(DVH_Graph g, int32_t node_id, int32_t param_id, int32_t sample_offset, float normalized);
+
 // Update the graph’s transport state. The native graph does not yet
 // perform tempo‑synchronized processing but this information is
 // preserved for future use. Returns 1 on success.
 DVH_API int32_t dvh_graph_set_transport(DVH_Graph g, DVH_Transport t);
 
-// Query the latency introduced by the graph in samples. At present
-// latency compensation is not implemented and this always returns 0.
+// Set the number of threads used to render each block, including the
+// thread calling dvh_graph_process_stereo(). With 1 (the default)
+// nodes run serially on the caller's thread. With more, independent
+// nodes run concurrently on a fixed pool of worker threads that
+// request real‑time priority; the output is identical to serial
+// rendering. Counts above the number of hardware threads are capped.
+// Must not be called from the audio thread. Returns 1 on success or 0
+// if threads is outside 1..64.
+DVH_API int32_t dvh_graph_set_thread_count(DVH_Graph g, int32_t threads);
+
+// Enable fixed‑quantum mode: host blocks of any size are buffered so
+// that the graph always renders internal blocks of exactly `frames`
+// samples, keeping the per‑block cost stable when the host sends odd
+// or varying block sizes. The output is delayed by `frames` samples,
+// which is included in dvh_graph_latency(). frames must not exceed
+// max_block; 0 disables the mode (the default). Event offsets passed
+// to the *_at functions stay relative to the next host block. Returns
+// 1 on success.
+DVH_API int32_t dvh_graph_set_block_quantum(DVH_Graph g, int32_t frames);
+
+// Switch the graph to 64‑bit (enable=1) or 32‑bit (enable=0)
+// rendering. In 64‑bit mode audio flows between nodes as doubles and
+// plug‑ins are asked to process 64‑bit samples; those that cannot are
+// fed converted 32‑bit audio, so precision is only lost at those
+// nodes. Either process function works in both modes, converting at
+// the graph boundary when the host's sample type differs. Must not be
+// called from the audio thread. Returns 1 on success.
+DVH_API int32_t dvh_graph_set_double_precision(DVH_Graph g, int32_t enable);
+
+// Whether a node is currently asleep. Nodes whose input has been
+// silent for longer than their tail (dvh_get_tail_samples() for
+// plug‑ins, 0 for built‑in nodes) and whose output has died away are
+// skipped until their input turns non‑silent or a note or parameter
+// change is sent to them. Silence is propagated along connections, so
+// idle parts of a large graph cost next to nothing. Returns 1 if the
+// node is asleep, 0 if it is awake or does not exist.
+DVH_API int32_t dvh_graph_is_sleeping(DVH_Graph g, int32_t node_id);
+
+// Query the latency introduced by the graph in samples: the longest
+// plug‑in latency path from the input node to the output node.
+// Shorter parallel paths are delayed internally so that every input
+// of a node lines up. Plug‑in latencies are re‑read on each edit. A
+// delay line keeps the audio it holds across edits as long as its
+// connection and length stay the same; new or resized ones start
+// silent.
 DVH_API int32_t dvh_graph_latency(DVH_Graph g);
 
 // Process a block of audio through the graph. The input and output
-// buffers must have at least num_frames samples. Returns 1 on
-// success; on failure the contents of outL/outR are undefined.
+// buffers must have at least num_frames samples. Any num_frames is
+// accepted: blocks larger than the graph's max_block are rendered in
+// max_block slices, with note and parameter offsets still applied at
+// the right frame. inL/inR may be null when there is no input (e.g.
+// instruments). Processing uses buffers preallocated when the graph
+// was last edited and never allocates. Returns 1 on success; on
+// failure the contents of outL/outR are undefined.
 DVH_API int32_t dvh_graph_process_stereo(DVH_Graph g,
                                          const float* inL, const float* inR,
                                          float* outL, float* outR,
                                          int32_t num_frames);
 
+// 64‑bit variant of dvh_graph_process_stereo(). Best used with
+// dvh_graph_set_double_precision() enabled.
+DVH_API int32_t dvh_graph_process_stereo_f64(DVH_Graph g,
+                                             const double* inL, const double* inR,
+                                             double* outL, double* outR,
+                                             int32_t num_frames);
+
+// Supplies input for dvh_graph_render_offline_source(). Called once
+// per slice of at most max_block frames with the slice's position in
+// the whole render; fills inL and inR with num_frames samples. The
+// buffers are zeroed before each call.
+typedef void (*DVH_RenderSource)(void* user, int64_t position,
+                                 float* inL, float* inR, int32_t num_frames);
+
+// Render num_frames of audio in one call, as fast as the CPU allows.
+// Every plug‑in is switched to offline processing for the duration of
+// the render and back to real time afterwards, and the audio is
+// processed in max_block slices. inL/inR may be null to render
+// silence through the graph (e.g. instruments). If samples_per_second
+// is not null it receives the render speed achieved; divide by the
+// sample rate for the speed relative to real time. Must not be called
+// while another thread is processing the graph. Returns 1 on success.
+DVH_API int32_t dvh_graph_render_offline(DVH_Graph g,
+                                         const float* inL, const float* inR,
+                                         float* outL, float* outR,
+                                         int64_t num_frames,
+                                         double* samples_per_second);
+
+// 64‑bit variant of dvh_graph_render_offline().
+DVH_API int32_t dvh_graph_render_offline_f64(DVH_Graph g,
+                                             const double* inL, const double* inR,
+                                             double* outL, double* outR,
+                                             int64_t num_frames,
+                                             double* samples_per_second);
+
+// Like dvh_graph_render_offline() but pulls the input from source,
+// so the whole input does not need to be held in memory.
+DVH_API int32_t dvh_graph_render_offline_source(DVH_Graph g,
+                                                DVH_RenderSource source, void* user,
+                                                float* outL, float* outR,
+                                                int64_t num_frames,
+                                                double* samples_per_second);
+
+// Number of stereo buffers the current render plan uses for node
+// outputs and sums. Buffers are reused once nothing reads their
+// contents any more, pass‑through nodes (splits) use their input's
+// buffer and gain nodes process in place, so the count follows the
+// width of the graph rather than its size. Intended for tests and
+// diagnostics.
+DVH_API int32_t dvh_graph_debug_buffer_count(DVH_Graph g);
+
+// Add a node that delays its input by `frames` samples and reports
+// that delay as its latency, with no tail. Stands in for a latent
+// plug‑in in tests and diagnostics.
+DVH_API int32_t dvh_graph_debug_add_delay(DVH_Graph g, int32_t frames, int32_t* out_id);
+
+// Number of heap allocations made from inside
+// dvh_graph_process_stereo() since the library was loaded. Only
+// available when built with DVH_GRAPH_TRACK_ALLOCATIONS; returns ‑1
+// otherwise. Intended for tests verifying the real‑time path.
+DVH_API int64_t dvh_graph_debug_alloc_count(void);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -2,7 +2,9 @@
 //
 // Implementation of a simple audio graph hosting multiple VST3 plug‑ins.
 // Nodes can be VST instances, mixers, splitters and gain controls.
-// Connections form a directed graph with one stereo bus per node.
+// Connections form a directed graph between stereo buses; several
+// connections into the same input bus are summed. Plug‑in latency is
+// compensated by delaying the shorter of any parallel paths.
 // The graph is processed sample accurate and supports note and
 // parameter automation. All functions are exposed via a C API for
 // consumption from Dart using FFI.
@@ -16,36 +18,212 @@
 #include <atomic>
 #include <cmath>
 #include <string>
-#include <unordered_map>
 #include <cstring>
+#include <algorithm>
+#include <new>
+#include <cstdlib>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <deque>
+#include <type_traits>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#ifdef DVH_GRAPH_TRACK_ALLOCATIONS
+// Allocation tracking used by tests to prove that the real‑time path
+// is allocation free. Only operator new calls made while a thread is
+// inside dvh_graph_process_stereo() are counted.
+static std::atomic<int64_t> g_processAllocs{0};
+static thread_local bool t_inProcess = false;
+
+void* operator new(std::size_t size) {
+  if (t_inProcess) g_processAllocs.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#endif
+
+// Hint to the CPU that we are spinning on a shared variable.
+static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+// Back off while waiting for another render thread: spin first, then
+// give the core away so an oversubscribed machine still makes progress.
+static inline void backoff(int& spins) {
+  if (++spins < 64) cpuRelax(); else std::this_thread::yield();
+}
+
+// Sample format conversion between float and double buffers, four
+// samples at a time where SSE2 or NEON is available.
+static inline void convertSamples(const float* src, double* dst, int n) {
+  int i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+  for (; i + 4 <= n; i += 4) {
+    const __m128 f = _mm_loadu_ps(src + i);
+    _mm_storeu_pd(dst + i, _mm_cvtps_pd(f));
+    _mm_storeu_pd(dst + i + 2, _mm_cvtps_pd(_mm_movehl_ps(f, f)));
+  }
+#elif defined(__aarch64__)
+  for (; i + 4 <= n; i += 4) {
+    const float32x4_t f = vld1q_f32(src + i);
+    vst1q_f64(dst + i, vcvt_f64_f32(vget_low_f32(f)));
+    vst1q_f64(dst + i + 2, vcvt_high_f64_f32(f));
+  }
+#endif
+  for (; i < n; i++) dst[i] = src[i];
+}
+static inline void convertSamples(const double* src, float* dst, int n) {
+  int i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+  for (; i + 4 <= n; i += 4) {
+    const __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(src + i));
+    const __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(src + i + 2));
+    _mm_storeu_ps(dst + i, _mm_movelh_ps(lo, hi));
+  }
+#elif defined(__aarch64__)
+  for (; i + 4 <= n; i += 4)
+    vst1q_f32(dst + i, vcvt_high_f32_f64(vcvt_f32_f64(vld1q_f64(src + i)), vld1q_f64(src + i + 2)));
+#endif
+  for (; i < n; i++) dst[i] = (float)src[i];
+}
+
+// Peak level below which a block counts as silent (‑160 dB).
+constexpr float kSilenceThreshold = 1e-8f;
+
+template <typename T>
+static bool isQuiet(const T* L, const T* R, int n) {
+  for (int i = 0; i < n; i++)
+    if (std::fabs(L[i]) > kSilenceThreshold || std::fabs(R[i]) > kSilenceThreshold) return false;
+  return true;
+}
 
 // A base class for all graph nodes. Subclasses implement audio
 // processing, note handling and parameter access. The default
 // implementation performs a bypass (zeros) and exposes no parameters.
+// Notes and parameter changes carry a sample offset into the next
+// processed block.
 struct Node {
   virtual ~Node() = default;
   virtual int32_t process(const float* inL, const float* inR, float* outL, float* outR, int32_t n) = 0;
-  virtual int32_t noteOn(int ch, int note, float vel) { (void)ch; (void)note; (void)vel; return 1; }
-  virtual int32_t noteOff(int ch, int note, float vel) { (void)ch; (void)note; (void)vel; return 1; }
+  virtual int32_t noteOn(int32_t offset, int ch, int note, float vel) { (void)offset; (void)ch; (void)note; (void)vel; return 1; }
+  virtual int32_t noteOff(int32_t offset, int ch, int note, float vel) { (void)offset; (void)ch; (void)note; (void)vel; return 1; }
   virtual int32_t paramCount() const { return 0; }
   virtual int32_t paramInfo(int idx, int32_t* id, std::string& title, std::string& units) { (void)idx; (void)id; title.clear(); units.clear(); return 0; }
   virtual float getParam(int32_t id) { (void)id; return 0.f; }
-  virtual int32_t setParam(int32_t id, float v) { (void)id; (void)v; return 0; }
+  virtual int32_t setParam(int32_t id, int32_t offset, float v) { (void)id; (void)offset; (void)v; return 0; }
   virtual int32_t latency() const { return 0; }
+  // Number of stereo input and output buses. Bus 0 is delivered via
+  // the process() arguments; nodes with more than one input bus also
+  // receive every bus through setInput() before each process() call.
+  virtual int32_t inputBusCount() const { return 1; }
+  virtual int32_t outputBusCount() const { return 1; }
+  virtual void setInput(int bus, const float* L, const float* R) { (void)bus; (void)L; (void)R; }
+  // Switch between real‑time and offline (bounce) processing.
+  virtual void setOffline(bool offline) { (void)offline; }
+  // 64‑bit processing, used when the graph renders in double
+  // precision. Nodes that cannot process doubles leave
+  // supportsDouble() false and the render plan converts around their
+  // float process() instead. Such nodes must have a single input bus.
+  virtual bool supportsDouble() const { return false; }
+  virtual int32_t process64(const double* inL, const double* inR, double* outL, double* outR, int32_t n) {
+    (void)inL; (void)inR; (void)outL; (void)outR; (void)n; return 0;
+  }
+  virtual void setInput64(int bus, const double* L, const double* R) { (void)bus; (void)L; (void)R; }
+  // Called on the editing thread when the graph's sample type changes.
+  virtual void setDoublePrecision(bool on) { (void)on; }
+  // A pass‑through node outputs its single input unchanged, so the
+  // render plan lets its output alias the input buffer and never calls
+  // process(). An in‑place node computes each output sample from the
+  // input sample at the same index only, so its output may overwrite
+  // its bus 0 input.
+  virtual bool passThrough() const { return false; }
+  virtual bool inPlace() const { return false; }
+  // Frames of output that may follow the last non‑silent input, or ‑1
+  // if the node never falls silent on its own. Re‑read on each edit.
+  virtual int32_t tailSamples() const { return 0; }
+  // Whether the node flagged its last output block as silent. Output
+  // that is not flagged is scanned instead.
+  virtual bool outputSilent() { return false; }
+
+  // Sleep state. A node whose input has been silent for longer than
+  // its latency plus its tail and whose output has died away is
+  // skipped until its
+  // input turns non‑silent or an event wakes it. wake() is called by
+  // editors after queuing an event `offset` frames into the next
+  // block; the node then stays awake until the event is due. The
+  // other fields belong to the render thread running the node.
+  void wake(int32_t offset) {
+    const int32_t frames = std::max(0, offset) + 1;
+    int32_t cur = wakeFor.load(std::memory_order_relaxed);
+    while (cur < frames && !wakeFor.compare_exchange_weak(cur, frames, std::memory_order_release)) {}
+  }
+  std::atomic<int32_t> wakeFor{0};
+  std::atomic<bool> asleep{false};
+  int64_t quietFor = 0; // frames of silent input without events
+  int32_t awakeFor = 0; // frames until the last queued event is due
 };
 
+// Overloads picking the process()/setInput() variant for a sample type.
+static inline int32_t runNode(Node& n, const float* inL, const float* inR, float* outL, float* outR, int32_t len) {
+  return n.process(inL, inR, outL, outR, len);
+}
+static inline int32_t runNode(Node& n, const double* inL, const double* inR, double* outL, double* outR, int32_t len) {
+  return n.process64(inL, inR, outL, outR, len);
+}
+static inline void setNodeInput(Node& n, int bus, const float* L, const float* R) { n.setInput(bus, L, R); }
+static inline void setNodeInput(Node& n, int bus, const double* L, const double* R) { n.setInput64(bus, L, R); }
+
 // A node wrapping a DVH_Plugin. Delegates processing, notes and
 // parameters to the underlying plug‑in. Owns the plug‑in and
 // unloads it on destruction.
 struct VstNode : Node {
   DVH_Plugin p{nullptr};
-  VstNode(DVH_Plugin plugin) : p(plugin) {}
+  bool wide = false; // plug‑in set up for 64‑bit samples
+  uint64_t silentMask = 0; // silence flags of a silent main output
+  VstNode(DVH_Plugin plugin) : p(plugin) {
+    const int32_t channels = std::min(dvh_get_bus_channels(p, 0, 0), 64);
+    silentMask = channels >= 64 ? ~uint64_t(0) : (uint64_t(1) << channels) - 1;
+  }
   ~VstNode() override { if (p) dvh_unload_plugin(p); }
   int32_t process(const float* inL, const float* inR, float* outL, float* outR, int32_t n) override {
     return dvh_process_stereo_f32(p, inL, inR, outL, outR, n);
   }
-  int32_t noteOn(int ch, int note, float vel) override { return dvh_note_on(p, ch, note, vel); }
-  int32_t noteOff(int ch, int note, float vel) override { return dvh_note_off(p, ch, note, vel); }
+  bool supportsDouble() const override { return wide; }
+  int32_t process64(const double* inL, const double* inR, double* outL, double* outR, int32_t n) override {
+    return dvh_process_stereo_f64(p, inL, inR, outL, outR, n);
+  }
+  // Plug‑ins that cannot process doubles stay at 32 bits and are
+  // converted by the plan.
+  void setDoublePrecision(bool on) override {
+    if (on == wide) return;
+    if (dvh_set_double_precision(p, on ? 1 : 0) == 1) wide = on;
+  }
+  int32_t noteOn(int32_t offset, int ch, int note, float vel) override { return dvh_note_on_at(p, offset, ch, note, vel); }
+  int32_t noteOff(int32_t offset, int ch, int note, float vel) override { return dvh_note_off_at(p, offset, ch, note, vel); }
   int32_t paramCount() const override { return dvh_param_count(p); }
   int32_t paramInfo(int idx, int32_t* id, std::string& t, std::string& u) override {
     char title[256]; char units[64]; int32_t pid = 0;
@@ -53,33 +231,61 @@ struct VstNode : Node {
     if (id) *id = pid; t = title; u = units; return 1;
   }
   float getParam(int32_t id) override { return dvh_get_param_normalized(p, id); }
-  int32_t setParam(int32_t id, float v) override { return dvh_set_param_normalized(p, id, v); }
+  int32_t setParam(int32_t id, int32_t offset, float v) override { return dvh_set_param_at(p, id, offset, v); }
+  int32_t latency() const override { return dvh_get_latency_samples(p); }
+  int32_t tailSamples() const override { return dvh_get_tail_samples(p); }
+  bool outputSilent() override {
+    uint64_t flags = 0;
+    return silentMask && dvh_get_silence_flags(p, 0, 0, &flags) == 1 && (flags & silentMask) == silentMask;
+  }
+  void setOffline(bool offline) override { dvh_set_offline(p, offline ? 1 : 0); }
+};
+
+// Stereo input pointers for each bus of a multi‑bus node.
+template <typename T>
+struct BusInputs {
+  std::vector<const T*> L;
+  std::vector<const T*> R;
+  explicit BusInputs(int n) : L(n, nullptr), R(n, nullptr) {}
+  void set(int i, const T* l, const T* r) {
+    if (i < 0 || i >= (int)L.size()) return;
+    L[i] = l;
+    R[i] = r;
+  }
 };
 
 // A mixer node sums multiple stereo inputs with per‑input gains. When
 // created the number of inputs is fixed. Each call to process()
-// accumulates inputs into the output buffer. Gains can be modified
-// directly via the gains vector.
+// accumulates inputs into the output buffer. Bus 0 comes from the
+// process() arguments like any node's, so a one‑input mixer, which
+// never receives setInput(), still hears its source. Gains can be
+// modified directly via the gains vector.
 struct MixerNode : Node {
-  std::vector<const float*> inputsL;
-  std::vector<const float*> inputsR;
+  BusInputs<float> inputs;
+  BusInputs<double> inputs64;
   std::vector<float> gains;
-  MixerNode(int n) : inputsL(n, nullptr), inputsR(n, nullptr), gains(n, 1.0f) {}
-  void setInput(int i, const float* L, const float* R) {
-    if (i < 0 || i >= (int)inputsL.size()) return;
-    inputsL[i] = L;
-    inputsR[i] = R;
+  MixerNode(int n) : inputs(n), inputs64(n), gains(n, 1.0f) {}
+  int32_t inputBusCount() const override { return (int32_t)gains.size(); }
+  void setInput(int i, const float* L, const float* R) override { inputs.set(i, L, R); }
+  void setInput64(int i, const double* L, const double* R) override { inputs64.set(i, L, R); }
+  bool supportsDouble() const override { return true; }
+  int32_t process(const float* inL, const float* inR, float* outL, float* outR, int32_t n) override {
+    return mix(inL, inR, inputs, outL, outR, n);
   }
-  int32_t process(const float*, const float*, float* outL, float* outR, int32_t n) override {
+  int32_t process64(const double* inL, const double* inR, double* outL, double* outR, int32_t n) override {
+    return mix(inL, inR, inputs64, outL, outR, n);
+  }
+  template <typename T>
+  int32_t mix(const T* busL, const T* busR, const BusInputs<T>& in, T* outL, T* outR, int32_t n) {
     for (int i = 0; i < n; i++) {
       outL[i] = 0;
       outR[i] = 0;
     }
-    for (size_t b = 0; b < inputsL.size(); ++b) {
-      auto inL = inputsL[b];
-      auto inR = inputsR[b];
+    for (size_t b = 0; b < gains.size(); ++b) {
+      auto inL = b == 0 ? busL : in.L[b];
+      auto inR = b == 0 ? busR : in.R[b];
       if (!inL || !inR) continue;
-      const float g = gains[b];
+      const T g = gains[b];
       for (int i = 0; i < n; i++) {
         outL[i] += inL[i] * g;
         outR[i] += inR[i] * g;
@@ -92,7 +298,16 @@ struct MixerNode : Node {
 // A splitter simply forwards its input to its output. If no input
 // connections are present the output is silenced.
 struct SplitNode : Node {
+  bool passThrough() const override { return true; }
   int32_t process(const float* inL, const float* inR, float* outL, float* outR, int32_t n) override {
+    return forward(inL, inR, outL, outR, n);
+  }
+  bool supportsDouble() const override { return true; }
+  int32_t process64(const double* inL, const double* inR, double* outL, double* outR, int32_t n) override {
+    return forward(inL, inR, outL, outR, n);
+  }
+  template <typename T>
+  static int32_t forward(const T* inL, const T* inR, T* outL, T* outR, int32_t n) {
     if (inL && inR) {
       for (int i = 0; i < n; i++) {
         outL[i] = inL[i];
@@ -108,17 +323,94 @@ struct SplitNode : Node {
   }
 };
 
+// A delay node plays its input back a fixed number of frames later and
+// reports that delay as its latency, with no tail of its own. Only
+// created through dvh_graph_debug_add_delay() so tests can exercise
+// latency compensation and sleeping without a plug‑in.
+struct DelayNode : Node {
+  std::vector<float> ringL, ringR;
+  int32_t pos = 0;
+  explicit DelayNode(int32_t frames) : ringL(std::max(1, frames)), ringR(std::max(1, frames)) {}
+  int32_t latency() const override { return (int32_t)ringL.size(); }
+  int32_t process(const float* inL, const float* inR, float* outL, float* outR, int32_t n) override {
+    const int32_t len = (int32_t)ringL.size();
+    for (int i = 0; i < n; i++) {
+      const float l = inL ? inL[i] : 0.f;
+      const float r = inR ? inR[i] : 0.f;
+      outL[i] = ringL[pos];
+      outR[i] = ringR[pos];
+      ringL[pos] = l;
+      ringR[pos] = r;
+      if (++pos == len) pos = 0;
+    }
+    return 1;
+  }
+};
+
 // A gain node applies a simple gain in dB to its input. The gain
 // parameter is exposed as a single parameter 0. Normalized values map
 // to dB in the range [‑60, 0].
+//
+// Parameter changes are sample accurate: setParam() queues a point
+// that process() applies at its offset. Points beyond the current
+// block stay queued with their offset moved to the next block. The
+// queue is guarded by a spin lock that the audio thread only ever
+// tries; if an editor holds it, due points are applied one block
+// late.
 struct GainNode : Node {
-  std::atomic<float> gdb;
-  GainNode(float dB) : gdb(dB) {}
+  static constexpr int kMaxPoints = 64;
+  struct Point {
+    int32_t offset;
+    float gain; // linear
+  };
+  std::atomic<float> gdb; // latest value set, for getParam()
+  std::atomic_flag busy = ATOMIC_FLAG_INIT;
+  Point pending[kMaxPoints];
+  int numPending = 0;
+  Point points[kMaxPoints]; // audio thread only
+  float gain;               // audio thread only
+  int skipped = 0;          // frames rendered since pending was rebased
+  GainNode(float dB) : gdb(dB), gain(std::pow(10.0f, dB * 0.05f)) {}
+  bool inPlace() const override { return true; }
   int32_t process(const float* inL, const float* inR, float* outL, float* outR, int32_t n) override {
-    const float g = std::pow(10.0f, gdb.load() * 0.05f);
-    for (int i = 0; i < n; i++) {
-      outL[i] = inL ? inL[i] * g : 0;
-      outR[i] = inR ? inR[i] * g : 0;
+    return apply(inL, inR, outL, outR, n);
+  }
+  bool supportsDouble() const override { return true; }
+  int32_t process64(const double* inL, const double* inR, double* outL, double* outR, int32_t n) override {
+    return apply(inL, inR, outL, outR, n);
+  }
+  template <typename T>
+  int32_t apply(const T* inL, const T* inR, T* outL, T* outR, int32_t n) {
+    int count = 0;
+    const int span = skipped + n;
+    if (!busy.test_and_set(std::memory_order_acquire)) {
+      int keep = 0;
+      for (int k = 0; k < numPending; ++k) {
+        Point pt = pending[k];
+        if (pt.offset < span) {
+          pt.offset = std::max(0, pt.offset - skipped);
+          points[count++] = pt;
+        } else {
+          pt.offset -= span;
+          pending[keep++] = pt;
+        }
+      }
+      numPending = keep;
+      busy.clear(std::memory_order_release);
+      skipped = 0;
+    } else {
+      skipped = span;
+    }
+    int pos = 0;
+    for (int k = 0; k <= count; ++k) {
+      const int end = k < count ? std::min(std::max(points[k].offset, pos), (int)n) : (int)n;
+      const T g = gain;
+      for (int i = pos; i < end; i++) {
+        outL[i] = inL ? inL[i] * g : 0;
+        outR[i] = inR ? inR[i] * g : 0;
+      }
+      pos = end;
+      if (k < count) gain = points[k].gain;
     }
     return 1;
   }
@@ -133,92 +425,1257 @@ struct GainNode : Node {
   float getParam(int32_t) override {
     return (gdb.load() + 60.f) / 60.f;
   }
-  int32_t setParam(int32_t, float v) override {
-    gdb.store(v * 60.f - 60.f);
+  // Queue a point, keeping the queue ordered by offset. When the queue
+  // is full the last point is replaced so the final value still wins.
+  int32_t setParam(int32_t, int32_t offset, float v) override {
+    if (offset < 0) return 0;
+    const float db = v * 60.f - 60.f;
+    const Point pt{offset, std::pow(10.0f, db * 0.05f)};
+    while (busy.test_and_set(std::memory_order_acquire)) cpuRelax();
+    int i = numPending < kMaxPoints ? numPending++ : kMaxPoints - 1;
+    for (; i > 0 && pending[i - 1].offset > offset; --i) pending[i] = pending[i - 1];
+    pending[i] = pt;
+    busy.clear(std::memory_order_release);
+    gdb.store(db);
     return 1;
   }
 };
 
-// Connection between nodes. Only one stereo bus per node for now.
-struct Conn { int src = -1; int dst = -1; };
-
-// Runtime buffer used during processing to store intermediate audio
-// between nodes. Either holds an external input pointer or owns a
-// local vector. The inL/inR pointers override the vector when set.
-struct RuntimeBuffer {
-  std::vector<float> L;
-  std::vector<float> R;
-  const float* inL = nullptr;
-  const float* inR = nullptr;
+// Connection from an output bus of one node to an input bus of
+// another. Any number of connections may share a source (fan‑out) or
+// a destination bus (fan‑in, summed).
+struct Conn {
+  int src = -1;
+  int srcBus = 0;
+  int dst = -1;
+  int dstBus = 0;
+  bool operator==(const Conn& o) const {
+    return src == o.src && srcBus == o.srcBus && dst == o.dst && dstBus == o.dstBus;
+  }
+};
+
+// Stereo buffer owned by a render plan. Sized to the graph's maximum
+// block when the plan is compiled and reused for every block so the
+// audio thread never touches the heap.
+template <typename T>
+struct PlanBuffer {
+  std::vector<T> L;
+  std::vector<T> R;
+  void assign(int n) {
+    L.assign(n, 0);
+    R.assign(n, 0);
+  }
+};
+
+// Fixed delay applied to one connection so that its signal arrives in
+// step with the destination's other, higher latency, inputs. The ring
+// holds exactly `delay` samples per channel and starts silent. A null
+// input is silence; once the ring holds nothing but silence the line
+// stops running and flags its output silent.
+template <typename T>
+struct DelayLine {
+  Conn conn;            // the connection it compensates
+  std::vector<T> ringL, ringR;
+  int pos = 0;
+  int64_t quietFor = 0; // frames of silent input
+  bool silent = false;  // the last delayed block is silent
+  PlanBuffer<T> out;    // delayed block, maxBlock samples
+  void run(const T* L, const T* R, int n) {
+    const int len = (int)ringL.size();
+    quietFor = L ? 0 : quietFor + n;
+    silent = quietFor >= len + n;
+    if (silent) return;
+    T* oL = out.L.data();
+    T* oR = out.R.data();
+    for (int i = 0; i < n; i++) {
+      oL[i] = ringL[pos];
+      oR[i] = ringR[pos];
+      ringL[pos] = L ? L[i] : 0;
+      ringR[pos] = R ? R[i] : 0;
+      if (++pos == len) pos = 0;
+    }
+  }
+};
+
+// Where the output of a node lives for the current block: a pooled
+// buffer, the buffer of the node it passes through, the caller's
+// output or the graph input. Null when the block is silent.
+template <typename T>
+struct BufferView {
+  const T* L = nullptr;
+  const T* R = nullptr;
+};
+
+// A connection that needs latency compensation and its delay in
+// frames.
+struct DelaySpec {
+  Conn conn;
+  int length = 0;
+};
+
+// Sample buffers of a render plan for one sample type. A plan only
+// fills the set matching the graph's precision. Node outputs and sums
+// share a pool of buffers assigned when the plan is compiled, so the
+// pool grows with the width of the graph rather than its size. The IO
+// pair converts host buffers of the other sample type.
+//
+// Delay lines are shared with the previous plan when their connection
+// and length are unchanged, so audio already inside them survives
+// edits elsewhere in the graph instead of restarting from silence.
+template <typename T>
+struct PlanBuffers {
+  std::vector<PlanBuffer<T>> pool;
+  std::vector<BufferView<T>> views; // index by node id
+  std::vector<std::shared_ptr<DelayLine<T>>> delays;
+  PlanBuffer<T> ioIn, ioOut;
+  void allocate(int numNodes, int numBuffers, const std::vector<DelaySpec>& delaySpecs, int maxBlock,
+                const PlanBuffers* previous) {
+    pool.resize(numBuffers);
+    for (auto& b : pool) b.assign(maxBlock);
+    views.assign(numNodes, BufferView<T>{});
+    delays.resize(delaySpecs.size());
+    for (size_t i = 0; i < delays.size(); ++i) {
+      const DelaySpec& spec = delaySpecs[i];
+      if (previous) {
+        for (const auto& d : previous->delays) {
+          if (d->conn == spec.conn && (int)d->ringL.size() == spec.length &&
+              (int)d->out.L.size() == maxBlock) {
+            delays[i] = d;
+            break;
+          }
+        }
+      }
+      if (delays[i]) continue;
+      delays[i] = std::make_shared<DelayLine<T>>();
+      delays[i]->conn = spec.conn;
+      delays[i]->ringL.assign(spec.length, 0);
+      delays[i]->ringR.assign(spec.length, 0);
+      delays[i]->out.assign(maxBlock);
+    }
+    ioIn.assign(maxBlock);
+    ioOut.assign(maxBlock);
+  }
+};
+
+// Float buffers for a node that cannot process doubles in a double
+// precision plan. Its input and output are converted around process().
+struct NarrowBuffers {
+  PlanBuffer<float> in;
+  PlanBuffer<float> out;
+};
+
+// One connection into an input bus: the source node and, when the
+// source's path has less latency than the destination's slowest
+// input, the delay line compensating the difference.
+struct PlanSource {
+  int node = -1;
+  int delay = -1; // index into RenderPlan::delays, ‑1 if none
+};
+
+// Sources feeding one input bus of a step. With no sources the bus
+// is silent (nullptr), with one undelayed source the node reads the
+// source's buffer directly and with several the sources are summed
+// into a pooled buffer.
+struct PlanInput {
+  int bus = 0;
+  std::vector<PlanSource> srcs;
+  int sum = -1; // pool index of the sum buffer, ‑1 if unused
+};
+
+// One entry of the render plan: the node to run, its connected input
+// buses and the buffer it renders into. Pass‑through steps have no
+// buffer; their view aliases their input.
+struct PlanStep {
+  Node* node = nullptr;
+  std::vector<PlanInput> inputs;
+  bool multiBus = false;
+  bool alias = false;
+  int out = -1; // node id
+  int buf = -1; // pool index of the output buffer
+  int narrow = -1; // index into RenderPlan::narrow, ‑1 if not converted
+  int32_t tail = 0; // node's latency plus tail in frames, ‑1 if it never sleeps
+};
+
+// Ask the OS to schedule the calling thread with real‑time priority.
+// Best effort: without the required privileges the thread simply keeps
+// its normal priority.
+static void raiseThreadPriority() {
+#if defined(_WIN32)
+  SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+#else
+  sched_param sp{};
+  sp.sched_priority = sched_get_priority_min(SCHED_FIFO) + 10;
+  pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+#endif
+}
+
+// Bounded deque of step indices owned by one render thread. The owner
+// pushes and pops at the back (LIFO keeps a chain on the same core);
+// other threads steal from the front. Critical sections are a few
+// instructions long so a spin lock is used instead of a mutex, which
+// could put the audio thread to sleep.
+struct WorkQueue {
+  std::atomic_flag busy = ATOMIC_FLAG_INIT;
+  std::vector<int> items; // capacity: number of plan steps
+  int head = 0;
+  int tail = 0;
+  void lock() {
+    while (busy.test_and_set(std::memory_order_acquire)) cpuRelax();
+  }
+  void unlock() { busy.clear(std::memory_order_release); }
+  void push(int k) {
+    lock();
+    items[tail++] = k;
+    unlock();
+  }
+  bool pop(int& k) {
+    lock();
+    bool ok = tail > head;
+    if (ok) k = items[--tail];
+    if (head == tail) head = tail = 0;
+    unlock();
+    return ok;
+  }
+  bool steal(int& k) {
+    lock();
+    bool ok = tail > head;
+    if (ok) k = items[head++];
+    if (head == tail) head = tail = 0;
+    unlock();
+    return ok;
+  }
+};
+
+// Fixed pool of worker threads used to render one block in parallel.
+// run() publishes a task, wakes the workers and runs the task on the
+// calling thread as participant 0; workers join as participants
+// 1..N. The task must be able to finish the whole block on its own, so
+// a worker that wakes late only costs parallelism, never correctness.
+// run() returns once every worker has left the task.
+class RenderPool {
+ public:
+  using Task = void (*)(void* ctx, int participant);
+  explicit RenderPool(int workers) {
+    threads.reserve(workers);
+    for (int i = 0; i < workers; ++i) threads.emplace_back([this, i] { workerLoop(i + 1); });
+  }
+  ~RenderPool() {
+    {
+      std::lock_guard<std::mutex> lk(m);
+      stop.store(true);
+    }
+    cv.notify_all();
+    for (auto& t : threads) t.join();
+  }
+  int participants() const { return (int)threads.size() + 1; }
+  // Called from the audio thread. Does not allocate or block on a lock;
+  // waking sleeping workers is a non‑blocking notify.
+  void run(Task t, void* c) {
+    task = t;
+    ctx = c;
+    active.store(true);
+    generation.fetch_add(1);
+    if (sleepers.load() > 0) cv.notify_all();
+    t(c, 0);
+    active.store(false);
+    for (int spins = 0; inFlight.load() != 0;) backoff(spins);
+  }
+
+ private:
+  // Spin briefly between blocks so back‑to‑back blocks do not pay for a
+  // wake up, then sleep until the next run().
+  void workerLoop(int participant) {
+    raiseThreadPriority();
+    uint64_t seen = generation.load();
+    while (!stop.load()) {
+      for (int spins = 0; spins < 4096 && generation.load() == seen && !stop.load();) backoff(spins);
+      if (generation.load() == seen) {
+        sleepers.fetch_add(1);
+        std::unique_lock<std::mutex> lk(m);
+        cv.wait(lk, [&] { return generation.load() != seen || stop.load(); });
+        sleepers.fetch_sub(1);
+      }
+      if (stop.load()) break;
+      seen = generation.load();
+      inFlight.fetch_add(1);
+      if (active.load()) task(ctx, participant);
+      inFlight.fetch_sub(1);
+    }
+  }
+  std::vector<std::thread> threads;
+  std::atomic<uint64_t> generation{0};
+  std::atomic<bool> active{false};
+  std::atomic<int> inFlight{0};
+  std::atomic<int> sleepers{0};
+  std::atomic<bool> stop{false};
+  Task task = nullptr;
+  void* ctx = nullptr;
+  std::mutex m;
+  std::condition_variable cv;
+};
+
+// FIFO pair for fixed‑quantum mode. Host blocks of any size are
+// collected into internal blocks of exactly `quantum` frames, so every
+// node always processes the same block size. Output lags input by one
+// quantum. The buffers are only touched by the audio thread; fill is
+// also read by editors to schedule events. FIFOs of both sample types
+// exist; only the one matching the graph's precision is used.
+struct BlockQuantizer {
+  int quantum;
+  PlanBuffer<float> in, out;
+  PlanBuffer<double> in64, out64;
+  std::atomic<int> fill{0}; // frames collected in `in`
+  explicit BlockQuantizer(int q) : quantum(q) {
+    in.assign(q);
+    out.assign(q);
+    in64.assign(q);
+    out64.assign(q);
+  }
+  template <typename T>
+  PlanBuffer<T>& input() {
+    if constexpr (std::is_same<T, double>::value) return in64; else return in;
+  }
+  template <typename T>
+  PlanBuffer<T>& output() {
+    if constexpr (std::is_same<T, double>::value) return out64; else return out;
+  }
+};
+
+// Render plan compiled whenever the graph is edited. Holds everything
+// process() needs so that a block can be rendered without allocating:
+// the ordered steps, a pool of preallocated buffers shared by the
+// steps (see assignBuffers()) and the resolved IO nodes. The quantizer
+// is shared between plans so its FIFO contents survive edits, and so
+// are unchanged delay lines. A published plan is immutable; edits
+// build a new plan and swap it in. The plan shares ownership of its nodes so
+// a node removed from the graph stays alive until every plan that
+// references it has been reclaimed.
+//
+// Buffers hold the graph's sample type. In double precision mode,
+// nodes that only process floats get a pair of float buffers and are
+// converted at their boundary; everything else stays in doubles.
+//
+// When rendering on several threads the plan also carries the step
+// dependency graph and the per‑block scheduling state (in‑degree
+// counters and one work queue per participant), all sized up front.
+struct RenderPlan {
+  std::vector<std::shared_ptr<Node>> nodes; // index by node id, null if removed
+  std::vector<PlanStep> steps;
+  bool wide = false; // renders in double precision
+  PlanBuffers<float> buffers;
+  PlanBuffers<double> buffers64;
+  std::vector<NarrowBuffers> narrow;
+  int ioIn = -1;
+  int ioOut = -1;
+  int latency = 0; // samples from graph input to graph output
+  std::shared_ptr<BlockQuantizer> quantizer; // null unless fixed‑quantum mode
+  std::shared_ptr<RenderPool> pool;         // null when rendering serially
+  std::vector<std::vector<int>> dependents; // step -> steps reading its output
+  std::vector<int> indegree;                // step -> number of source steps
+  std::vector<int> roots;                   // steps with no source steps
+  std::unique_ptr<std::atomic<int>[]> pending;
+  std::unique_ptr<WorkQueue[]> queues;
+  std::atomic<int> remaining{0};
+  template <typename T>
+  PlanBuffers<T>& bufs() {
+    if constexpr (std::is_same<T, double>::value) return buffers64; else return buffers;
+  }
+};
+
+// Host buffers of one block and whether the output node renders
+// directly into outL/outR. Input pointers are null when silent.
+template <typename T>
+struct BlockIO {
+  const T* inL;
+  const T* inR;
+  T* outL;
+  T* outR;
+  int n;
+  bool direct;
 };
 
 // Internal graph implementation. Owns all nodes, manages the
-// connection list and processes audio in a single topologically
-// ordered pass. Also owns a DVH_Host used to load plug‑ins.
+// connection list and processes audio in topological order. The order
+// is computed on every edit and baked into the render plan. By default
+// a block is rendered on the caller's thread; with a thread count
+// above one, independent nodes run concurrently on a RenderPool. Also
+// owns a DVH_Host used to load plug‑ins.
+//
+// Editing and rendering never share a lock. Edits are serialized by
+// editMtx and publish a new RenderPlan through an atomic pointer; the
+// audio thread picks up whichever plan is current at the start of a
+// block. Readers announce the plan they use in a hazard slot and the
+// editor only frees retired plans that no slot references, so
+// reclamation (including destruction of removed nodes) always happens
+// on the editing thread.
 struct GraphImpl {
+  static constexpr int kHazardSlots = 8;
+  static constexpr int kMaxThreads = 64;
+
   std::mutex editMtx;
   double sr;
   int maxBlock;
   DVH_Host host{nullptr};
   DVH_Transport transport{};
-  std::vector<std::unique_ptr<Node>> nodes;
-  std::unordered_map<int,int> latency; // nodeId -> samples
-  std::vector<Conn> edges; // index by destination node id
+  std::vector<std::shared_ptr<Node>> nodes; // index by node id, null if removed
+  std::vector<Conn> edges;
   int ioIn = -1;
   int ioOut = -1;
-  GraphImpl(double s, int m) : sr(s), maxBlock(m) {
+  int threads = 1;
+  std::shared_ptr<RenderPool> pool;
+  std::shared_ptr<BlockQuantizer> quantizer;
+  bool wide = false;            // render in double precision
+  std::vector<float> silence;   // maxBlock zeros for unconnected inputs
+  std::vector<double> silence64;
+  std::atomic<RenderPlan*> current{nullptr};
+  std::atomic<RenderPlan*> hazards[kHazardSlots];
+  std::unique_ptr<RenderPlan> live;
+  std::vector<std::unique_ptr<RenderPlan>> retired;
+  uint64_t epoch = 0; // bumped by clear() to orphan pending loads
+
+  // Background plug‑in loading. A request reserves its node ID up
+  // front so IDs follow request order; loader threads instantiate and
+  // resume the plug‑in, then attach it with a single plan swap.
+  struct LoadJob {
+    std::string path;
+    std::string uid;
+    bool hasUid;
+    int node;
+    uint64_t epoch;
+    int status; // DVH_LOAD_*
+  };
+  std::mutex loadMtx;
+  std::condition_variable loadCv;
+  std::vector<LoadJob> loads; // index by request ID - 1
+  std::deque<int> loadQueue;
+  std::vector<std::thread> loaders;
+  int idleLoaders = 0;
+  int loadsDone = 0;
+  int loadsTotal = 0;
+  bool loadStop = false;
+
+  GraphImpl(double s, int m) : sr(s), maxBlock(m), silence(m, 0.f), silence64(m, 0.0) {
+    for (auto& h : hazards) h.store(nullptr);
     host = dvh_create_host(sr, maxBlock);
+    compile();
+  }
+  ~GraphImpl() {
+    {
+      // Drop queued loads and wait for the ones in progress.
+      std::lock_guard<std::mutex> g(loadMtx);
+      loadStop = true;
+      loadQueue.clear();
+    }
+    loadCv.notify_all();
+    for (auto& t : loaders) t.join();
+    current.store(nullptr);
+    retired.clear();
+    live.reset();
+    nodes.clear();
+    if (host) dvh_destroy_host(host);
+  }
+  // Order nodes so that each runs after its sources using Kahn's
+  // algorithm. Sources are released in index order which keeps the
+  // schedule deterministic. Returns false if the edges form a cycle,
+  // in which case order holds only the nodes that could be placed.
+  static bool topoSort(const std::vector<std::shared_ptr<Node>>& n,
+                       const std::vector<Conn>& e, std::vector<int>& order) {
+    const int count = (int)n.size();
+    std::vector<int> indegree(count, 0);
+    std::vector<std::vector<int>> succ(count);
+    for (const auto& c : e) {
+      indegree[c.dst]++;
+      succ[c.src].push_back(c.dst);
+    }
+    int live = 0;
+    order.clear();
+    for (int i = 0; i < count; ++i) {
+      if (!n[i]) continue;
+      live++;
+      if (indegree[i] == 0) order.push_back(i);
+    }
+    for (size_t head = 0; head < order.size(); ++head) {
+      for (int d : succ[order[head]])
+        if (--indegree[d] == 0) order.push_back(d);
+    }
+    return (int)order.size() == live;
+  }
+  // Assign pooled buffers to node outputs and sums, much like a
+  // register allocator. Each output and each sum is a value with one
+  // writing step and the steps reading it; pass‑through steps add
+  // their readers to their input's value instead of creating one. A
+  // buffer is handed to a new value once its writer and every reader
+  // of its old value are ancestors of the new writer, so reuse is safe
+  // whichever order parallel threads run steps in. An in‑place node
+  // may also take over its bus 0 input if it is that value's last
+  // reader. The graph output's value is never reused. Sets
+  // PlanStep::alias/buf and PlanInput::sum and returns the pool size.
+  static int assignBuffers(RenderPlan& p, int numNodes) {
+    const int steps = (int)p.steps.size();
+    const int words = (steps + 63) / 64;
+    std::vector<int> stepOf(numNodes, -1);
+    for (int k = 0; k < steps; ++k) stepOf[p.steps[k].out] = k;
+    // Row k holds the steps that finish before step k starts.
+    std::vector<uint64_t> anc((size_t)steps * words, 0);
+    auto isAnc = [&](int k, int a) { return (anc[(size_t)k * words + a / 64] >> (a % 64)) & 1; };
+    for (int k = 0; k < steps; ++k) {
+      uint64_t* row = &anc[(size_t)k * words];
+      for (const auto& in : p.steps[k].inputs)
+        for (const auto& src : in.srcs) {
+          const int a = stepOf[src.node];
+          const uint64_t* from = &anc[(size_t)a * words];
+          for (int w = 0; w < words; ++w) row[w] |= from[w];
+          row[a / 64] |= uint64_t(1) << (a % 64);
+        }
+    }
+
+    struct Value {
+      int writer;
+      std::vector<int> readers;
+      bool pinned = false;
+      int buf = -1;
+    };
+    std::vector<Value> values;
+    std::vector<int> valueOf(numNodes, -1); // value holding a node's output, ‑1 if not pooled
+    std::vector<std::vector<int>> sums(steps);
+    for (int k = 0; k < steps; ++k) {
+      PlanStep& st = p.steps[k];
+      for (const auto& in : st.inputs) {
+        for (const auto& src : in.srcs)
+          if (src.node != p.ioIn && valueOf[src.node] >= 0) values[valueOf[src.node]].readers.push_back(k);
+        sums[k].push_back(-1);
+        if (in.srcs.size() < 2) continue;
+        sums[k].back() = (int)values.size();
+        values.push_back(Value{k, {k}});
+      }
+      st.alias = st.node->passThrough() && !st.multiBus;
+      if (!st.alias) {
+        valueOf[st.out] = (int)values.size();
+        values.push_back(Value{k, {}});
+        continue;
+      }
+      // The graph input, delay lines and silence are not pooled.
+      for (size_t b = 0; b < st.inputs.size(); ++b) {
+        const PlanInput& in = st.inputs[b];
+        if (in.bus != 0) continue;
+        if (in.srcs.size() > 1) valueOf[st.out] = sums[k][b];
+        else if (in.srcs[0].delay < 0 && in.srcs[0].node != p.ioIn) valueOf[st.out] = valueOf[in.srcs[0].node];
+      }
+    }
+    if (p.ioOut >= 0 && p.ioOut != p.ioIn && valueOf[p.ioOut] >= 0) values[valueOf[p.ioOut]].pinned = true;
+
+    std::vector<int> occupant; // value currently held by each buffer
+    auto reusable = [&](int v, int k, bool inPlace) {
+      const Value& val = values[v];
+      if (val.pinned) return false;
+      if (!(inPlace && val.writer == k) && !isAnc(k, val.writer)) return false;
+      for (int r : val.readers)
+        if (!(inPlace && r == k) && !isAnc(k, r)) return false;
+      return true;
+    };
+    auto place = [&](int v, int k) {
+      for (size_t b = 0; b < occupant.size(); ++b) {
+        if (!reusable(occupant[b], k, false)) continue;
+        occupant[b] = v;
+        values[v].buf = (int)b;
+        return;
+      }
+      values[v].buf = (int)occupant.size();
+      occupant.push_back(v);
+    };
+    for (int k = 0; k < steps; ++k) {
+      PlanStep& st = p.steps[k];
+      for (int v : sums[k])
+        if (v >= 0) place(v, k);
+      if (st.alias) continue;
+      const int v = valueOf[st.out];
+      int input = -1;
+      for (size_t b = 0; b < st.inputs.size() && st.node->inPlace(); ++b) {
+        const PlanInput& in = st.inputs[b];
+        if (in.bus != 0) continue;
+        if (in.srcs.size() > 1) input = sums[k][b];
+        else if (in.srcs[0].delay < 0 && in.srcs[0].node != p.ioIn) input = valueOf[in.srcs[0].node];
+      }
+      if (input >= 0 && reusable(input, k, true)) {
+        values[v].buf = values[input].buf;
+        occupant[values[v].buf] = v;
+      } else {
+        place(v, k);
+      }
+    }
+    for (int k = 0; k < steps; ++k) {
+      PlanStep& st = p.steps[k];
+      for (size_t b = 0; b < st.inputs.size(); ++b) st.inputs[b].sum = sums[k][b] < 0 ? -1 : values[sums[k][b]].buf;
+      st.buf = st.alias ? -1 : values[valueOf[st.out]].buf;
+    }
+    return (int)occupant.size();
+  }
+  // Rebuild the render plan from the current nodes and edges and
+  // publish it. Must be called with editMtx held (or before the graph
+  // is shared). All allocation for processing happens here.
+  void compile() {
+    auto p = std::make_unique<RenderPlan>();
+    const int count = (int)nodes.size();
+    p->nodes = nodes;
+    p->wide = wide;
+    auto valid = [&](int id) { return id >= 0 && id < count && nodes[id]; };
+    p->ioIn = valid(ioIn) ? ioIn : -1;
+    if (ioOut < 0) {
+      for (int i = count - 1; i >= 0 && p->ioOut < 0; --i)
+        if (nodes[i]) p->ioOut = i;
+    } else {
+      p->ioOut = valid(ioOut) ? ioOut : -1;
+    }
+    // Nodes run in topological order so every node sees its source's
+    // output from the current block. Edits that would introduce a
+    // cycle are rejected before they reach this point.
+    std::vector<int> order;
+    topoSort(nodes, edges, order);
+    // Latency compensation. A node's inputs arrive at the latest time
+    // any of its sources is ready (the longest path from the graph
+    // input) and its output is ready its own latency later. Every
+    // connection from a source that is ready earlier is delayed by the
+    // difference so all inputs of a node line up. Nodes read the graph
+    // input directly, so the input node is ready at 0. Latencies are
+    // queried on every edit.
+    std::vector<int> arrive(count, 0), ready(count, 0);
+    auto readyAt = [&](int id) { return id == p->ioIn ? 0 : ready[id]; };
+    for (int i : order) {
+      for (const auto& c : edges)
+        if (c.dst == i) arrive[i] = std::max(arrive[i], readyAt(c.src));
+      ready[i] = arrive[i] + std::max(0, (int)nodes[i]->latency());
+    }
+    p->latency = p->ioOut < 0 ? 0 : readyAt(p->ioOut);
+    p->quantizer = quantizer;
+    if (quantizer) p->latency += quantizer->quantum;
+    p->steps.reserve(order.size());
+    std::vector<DelaySpec> delaySpecs;
+    for (int i : order) {
+      PlanStep st;
+      st.node = nodes[i].get();
+      st.out = i;
+      st.multiBus = st.node->inputBusCount() > 1;
+      // Input still inside the node's latency has not come out yet, so
+      // the node may only sleep once that has passed as well.
+      const int32_t tail = st.node->tailSamples();
+      st.tail = tail < 0 ? -1 : tail + std::max(0, (int)st.node->latency());
+      if (wide && !st.node->supportsDouble()) {
+        st.narrow = (int)p->narrow.size();
+        p->narrow.emplace_back();
+        p->narrow.back().in.assign(maxBlock);
+        p->narrow.back().out.assign(maxBlock);
+      }
+      for (const auto& c : edges) {
+        if (c.dst != i) continue;
+        auto it = st.inputs.begin();
+        while (it != st.inputs.end() && it->bus != c.dstBus) ++it;
+        if (it == st.inputs.end()) {
+          st.inputs.emplace_back();
+          st.inputs.back().bus = c.dstBus;
+          it = st.inputs.end() - 1;
+        }
+        PlanSource src;
+        src.node = c.src;
+        const int lag = arrive[i] - readyAt(c.src);
+        if (lag > 0) {
+          src.delay = (int)delaySpecs.size();
+          delaySpecs.push_back({c, lag});
+        }
+        it->srcs.push_back(src);
+      }
+      p->steps.push_back(std::move(st));
+    }
+    const int numBuffers = assignBuffers(*p, count);
+    if (wide) p->buffers64.allocate(count, numBuffers, delaySpecs, maxBlock, live ? &live->buffers64 : nullptr);
+    else p->buffers.allocate(count, numBuffers, delaySpecs, maxBlock, live ? &live->buffers : nullptr);
+    if (pool) {
+      // Step k depends on every step rendering one of its sources. A
+      // source may feed several buses of k but is counted once.
+      const int steps = (int)p->steps.size();
+      std::vector<int> stepOf(count, -1);
+      for (int k = 0; k < steps; ++k) stepOf[p->steps[k].out] = k;
+      p->dependents.resize(steps);
+      p->indegree.assign(steps, 0);
+      for (int k = 0; k < steps; ++k) {
+        std::vector<int> srcs;
+        for (const auto& in : p->steps[k].inputs)
+          for (const auto& src : in.srcs)
+            if (std::find(srcs.begin(), srcs.end(), stepOf[src.node]) == srcs.end()) srcs.push_back(stepOf[src.node]);
+        for (int s : srcs) p->dependents[s].push_back(k);
+        p->indegree[k] = (int)srcs.size();
+        if (srcs.empty()) p->roots.push_back(k);
+      }
+      p->pool = pool;
+      p->pending.reset(new std::atomic<int>[steps]);
+      p->queues.reset(new WorkQueue[threads]);
+      for (int t = 0; t < threads; ++t) p->queues[t].items.resize(steps);
+    }
+    publish(std::move(p));
+  }
+  // Swap in a new plan and retire the previous one. Retired plans are
+  // freed here, on the editing thread, once no reader holds them.
+  void publish(std::unique_ptr<RenderPlan>&& p) {
+    current.store(p.get());
+    if (live) retired.push_back(std::move(live));
+    live = std::move(p);
+    reclaim();
+  }
+  void reclaim() {
+    auto inUse = [&](RenderPlan* p) {
+      for (auto& h : hazards)
+        if (h.load() == p) return true;
+      return false;
+    };
+    for (size_t i = 0; i < retired.size();) {
+      if (inUse(retired[i].get())) {
+        ++i;
+      } else {
+        retired[i] = std::move(retired.back());
+        retired.pop_back();
+      }
+    }
+  }
+  // Pin the current plan so it cannot be reclaimed while it is being
+  // read. Claims a free hazard slot, then re‑validates that the plan
+  // is still current so the editor cannot miss the announcement.
+  // Lock free and allocation free; safe to call from the audio thread.
+  RenderPlan* acquire(int& slot) {
+    for (;;) {
+      for (int i = 0; i < kHazardSlots; ++i) {
+        RenderPlan* p = current.load();
+        RenderPlan* expected = nullptr;
+        if (!hazards[i].compare_exchange_strong(expected, p)) continue;
+        for (;;) {
+          RenderPlan* q = current.load();
+          if (q == p) {
+            slot = i;
+            return p;
+          }
+          hazards[i].store(q);
+          p = q;
+        }
+      }
+    }
+  }
+  void release(int slot) { hazards[slot].store(nullptr); }
+  // Look up a live node in the current plan and pass it to fn while
+  // the plan is pinned. Returns fail if the node does not exist.
+  template <typename Fn, typename R>
+  R withNode(int id, R fail, Fn&& fn) {
+    int slot = 0;
+    RenderPlan* p = acquire(slot);
+    R r = fail;
+    if (id >= 0 && id < (int)p->nodes.size() && p->nodes[id]) r = fn(*p->nodes[id]);
+    release(slot);
+    return r;
   }
-  ~GraphImpl() { if (host) dvh_destroy_host(host); }
-  int addNode(std::unique_ptr<Node>&& n) {
+  // Invoke fn on every live node of the current plan.
+  template <typename Fn>
+  void forEachNode(Fn&& fn) {
+    int slot = 0;
+    RenderPlan* p = acquire(slot);
+    for (auto& n : p->nodes)
+      if (n) fn(*n);
+    release(slot);
+  }
+  int addNode(std::shared_ptr<Node>&& n) {
     std::lock_guard<std::mutex> g(editMtx);
+    n->setDoublePrecision(wide);
     nodes.push_back(std::move(n));
-    edges.resize((int)nodes.size());
+    compile();
     return (int)nodes.size() - 1;
   }
-  int setEdge(int s, int d) {
+  // Remove a node and every connection touching it. Node IDs are never
+  // reused so the remaining IDs stay valid.
+  int removeNode(int id) {
     std::lock_guard<std::mutex> g(editMtx);
-    if (s < 0 || d < 0 || s >= (int)nodes.size() || d >= (int)nodes.size()) return 0;
-    edges[d].src = s;
-    edges[d].dst = d;
+    if (id < 0 || id >= (int)nodes.size() || !nodes[id]) return 0;
+    nodes[id].reset();
+    edges.erase(std::remove_if(edges.begin(), edges.end(),
+                               [&](const Conn& c) { return c.src == id || c.dst == id; }),
+                edges.end());
+    if (ioIn == id) ioIn = -1;
+    if (ioOut == id) ioOut = -1;
+    compile();
     return 1;
   }
-  int clearEdge(int s, int d) {
+  int clear() {
     std::lock_guard<std::mutex> g(editMtx);
-    if (d < 0 || d >= (int)edges.size()) return 0;
-    if (edges[d].src == s) edges[d].src = -1;
+    epoch++;
+    nodes.clear();
+    edges.clear();
+    ioIn = -1;
+    ioOut = -1;
+    compile();
     return 1;
   }
-  int process(const float* inL, const float* inR, float* outL, float* outR, int n) {
-    std::vector<RuntimeBuffer> bufs(nodes.size());
-    for (auto& b : bufs) {
-      b.L.assign(n, 0);
-      b.R.assign(n, 0);
-      b.inL = nullptr;
-      b.inR = nullptr;
-    }
-    if (ioIn >= 0) {
-      bufs[ioIn].inL = inL;
-      bufs[ioIn].inR = inR;
-    }
-    // process nodes in index order (simple linear graph). For a
-    // topologically complex graph a proper sort would be needed.
-    for (int i = 0; i < (int)nodes.size(); ++i) {
-      const float* srcL = nullptr;
-      const float* srcR = nullptr;
-      if (edges[i].src >= 0) {
-        auto& sb = bufs[edges[i].src];
-        srcL = sb.inL ? sb.inL : sb.L.data();
-        srcR = sb.inR ? sb.inR : sb.R.data();
+  // Queue a plug‑in for loading on the loader threads. Returns the
+  // request ID. Loader threads are started on demand, up to one per
+  // core, and stay parked until the graph is destroyed.
+  int requestLoad(const char* path, const char* uid) {
+    LoadJob job{path, uid ? uid : "", uid != nullptr, -1, 0, DVH_LOAD_PENDING};
+    {
+      std::lock_guard<std::mutex> g(editMtx);
+      job.node = (int)nodes.size();
+      job.epoch = epoch;
+      nodes.push_back(nullptr);
+    }
+    std::lock_guard<std::mutex> g(loadMtx);
+    if (loadsDone == loadsTotal) loadsDone = loadsTotal = 0;
+    loadsTotal++;
+    loads.push_back(std::move(job));
+    loadQueue.push_back((int)loads.size() - 1);
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    if ((int)loadQueue.size() > idleLoaders && loaders.size() < cores)
+      loaders.emplace_back([this] { loaderLoop(); });
+    loadCv.notify_one();
+    return (int)loads.size();
+  }
+  void loaderLoop() {
+    std::unique_lock<std::mutex> lk(loadMtx);
+    for (;;) {
+      idleLoaders++;
+      loadCv.wait(lk, [&] { return loadStop || !loadQueue.empty(); });
+      idleLoaders--;
+      if (loadStop) return;
+      const int r = loadQueue.front();
+      loadQueue.pop_front();
+      const LoadJob job = loads[r];
+      lk.unlock();
+
+      DVH_Plugin p = dvh_load_plugin(host, job.path.c_str(), job.hasUid ? job.uid.c_str() : nullptr);
+      if (p && dvh_resume(p, sr, maxBlock) != 1) {
+        dvh_unload_plugin(p);
+        p = nullptr;
+      }
+      bool ok = false;
+      if (p) {
+        auto n = std::make_shared<VstNode>(p);
+        std::lock_guard<std::mutex> g(editMtx);
+        if (job.epoch == epoch) {
+          n->setDoublePrecision(wide);
+          nodes[job.node] = std::move(n);
+          compile();
+          ok = true;
+        }
       }
-      auto& b = bufs[i];
-      nodes[i]->process(srcL, srcR, b.L.data(), b.R.data(), n);
+
+      lk.lock();
+      loads[r].status = ok ? DVH_LOAD_DONE : DVH_LOAD_FAILED;
+      loadsDone++;
     }
-    const auto& ob = bufs[ioOut < 0 ? (int)nodes.size() - 1 : ioOut];
-    for (int i = 0; i < n; i++) {
-      outL[i] = (ob.inL ? ob.inL[i] : ob.L[i]);
-      outR[i] = (ob.inR ? ob.inR[i] : ob.R[i]);
+  }
+  int pollLoad(int request, int* node) {
+    std::lock_guard<std::mutex> g(loadMtx);
+    if (request <= 0 || request > (int)loads.size()) return DVH_LOAD_FAILED;
+    const LoadJob& job = loads[request - 1];
+    if (job.status == DVH_LOAD_DONE && node) *node = job.node;
+    return job.status;
+  }
+  int loadProgress(int* done, int* total) {
+    std::lock_guard<std::mutex> g(loadMtx);
+    if (done) *done = loadsDone;
+    if (total) *total = loadsTotal;
+    return loadsTotal - loadsDone;
+  }
+  int setIO(int in, int out) {
+    std::lock_guard<std::mutex> g(editMtx);
+    ioIn = in;
+    ioOut = out;
+    compile();
+    return 1;
+  }
+  // Render a whole buffer as fast as possible. Every node is switched
+  // to offline processing for the duration of the call and the buffer
+  // is processed in maxBlock slices, bypassing fixed‑quantum mode;
+  // next(pos, n, L, R) supplies the input of each slice. Reports the samples per second achieved by
+  // the render loop.
+  template <typename T, typename Source>
+  int renderOffline(Source&& next, T* outL, T* outR, int64_t frames, double* sps) {
+    if (frames < 0 || !outL || !outR) return 0;
+    forEachNode([](Node& n) { n.setOffline(true); });
+    const auto start = std::chrono::steady_clock::now();
+    for (int64_t pos = 0; pos < frames; pos += maxBlock) {
+      const int n = (int)std::min<int64_t>(maxBlock, frames - pos);
+      const T* L = nullptr;
+      const T* R = nullptr;
+      next(pos, n, L, R);
+      int slot = 0;
+      RenderPlan& p = *acquire(slot);
+      withPlanType(p, L, R, outL + pos, outR + pos, n,
+                   [&](auto* bL, auto* bR, auto* oL, auto* oR, int len) { renderBlock(p, bL, bR, oL, oR, len); });
+      release(slot);
+    }
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    forEachNode([](Node& n) { n.setOffline(false); });
+    if (sps) *sps = secs > 0 ? (double)frames / secs : 0;
+    return 1;
+  }
+  // Switch the graph between 32‑bit and 64‑bit rendering. In 64‑bit
+  // mode node buffers hold doubles and plug‑ins that cannot process
+  // 64‑bit samples are converted at their own inputs and outputs.
+  int setDoublePrecision(bool on) {
+    std::lock_guard<std::mutex> g(editMtx);
+    if (wide == on) return 1;
+    for (auto& n : nodes)
+      if (n) n->setDoublePrecision(on);
+    wide = on;
+    compile();
+    return 1;
+  }
+  // Enable fixed‑quantum mode with blocks of q frames, or disable it
+  // with 0. Reported latency grows by q while enabled.
+  int setBlockQuantum(int q) {
+    if (q < 0 || q > maxBlock) return 0;
+    std::lock_guard<std::mutex> g(editMtx);
+    if ((quantizer ? quantizer->quantum : 0) == q) return 1;
+    quantizer = q > 0 ? std::make_shared<BlockQuantizer>(q) : nullptr;
+    compile();
+    return 1;
+  }
+  // Translate an event offset relative to the next host block into an
+  // offset relative to the next internal block. In fixed‑quantum mode
+  // the next internal block started `fill` frames before the host
+  // block; nodes hold events beyond their current block until the
+  // block they fall in.
+  int32_t eventOffset(int32_t offset) {
+    int slot = 0;
+    RenderPlan* p = acquire(slot);
+    if (p->quantizer) offset += p->quantizer->fill.load(std::memory_order_relaxed);
+    release(slot);
+    return offset;
+  }
+  // Total latency of the graph in samples as of the last edit.
+  int totalLatency() {
+    int slot = 0;
+    int l = acquire(slot)->latency;
+    release(slot);
+    return l;
+  }
+  // Set the number of threads used to render a block, including the
+  // caller's. The count is capped at the number of hardware threads
+  // since spinning workers on a shared core only slow rendering down.
+  // Workers are created here, on the editing thread; the old pool is
+  // joined once the last plan using it has been reclaimed.
+  int setThreadCount(int n) {
+    if (n < 1 || n > kMaxThreads) return 0;
+    const int hw = (int)std::thread::hardware_concurrency();
+    if (hw > 0 && n > hw) n = hw;
+    std::lock_guard<std::mutex> g(editMtx);
+    if (n == threads) return 1;
+    threads = n;
+    pool = n > 1 ? std::make_shared<RenderPool>(n - 1) : nullptr;
+    compile();
+    return 1;
+  }
+  // Add a connection after validating node IDs and bus indices. The
+  // edge is rejected if it already exists or would create a cycle.
+  int setEdge(const Conn& c) {
+    std::lock_guard<std::mutex> g(editMtx);
+    const int count = (int)nodes.size();
+    if (c.src < 0 || c.dst < 0 || c.src >= count || c.dst >= count) return 0;
+    if (!nodes[c.src] || !nodes[c.dst]) return 0;
+    if (c.srcBus < 0 || c.srcBus >= nodes[c.src]->outputBusCount()) return 0;
+    if (c.dstBus < 0 || c.dstBus >= nodes[c.dst]->inputBusCount()) return 0;
+    if (std::find(edges.begin(), edges.end(), c) != edges.end()) return 0;
+    edges.push_back(c);
+    std::vector<int> order;
+    if (!topoSort(nodes, edges, order)) {
+      edges.pop_back();
+      return 0;
     }
+    compile();
+    return 1;
+  }
+  int clearEdge(const Conn& c) {
+    std::lock_guard<std::mutex> g(editMtx);
+    auto it = std::find(edges.begin(), edges.end(), c);
+    if (it == edges.end()) return 0;
+    edges.erase(it);
+    compile();
+    return 1;
+  }
+  // Resolve the audio for one input bus. Single undelayed sources are
+  // read in place; delayed sources are read from their delay line and
+  // multiple sources are summed into the bus's sum buffer. A silent
+  // bus resolves to nullptr; silent sources are left out of sums.
+  template <typename T>
+  void gather(RenderPlan& p, const PlanInput& in, const T* inL, const T* inR,
+              int n, const T*& L, const T*& R) {
+    PlanBuffers<T>& bufs = p.bufs<T>();
+    auto source = [&](const PlanSource& s, const T*& sL, const T*& sR) {
+      sL = s.node == p.ioIn ? inL : bufs.views[s.node].L;
+      sR = s.node == p.ioIn ? inR : bufs.views[s.node].R;
+      if (s.delay < 0) return;
+      auto& d = *bufs.delays[s.delay];
+      d.run(sL, sR, n);
+      sL = d.silent ? nullptr : d.out.L.data();
+      sR = d.silent ? nullptr : d.out.R.data();
+    };
+    L = R = nullptr;
+    if (in.srcs.empty()) return;
+    if (in.sum < 0) {
+      source(in.srcs[0], L, R);
+      return;
+    }
+    T* sL = bufs.pool[in.sum].L.data();
+    T* sR = bufs.pool[in.sum].R.data();
+    for (const auto& src : in.srcs) {
+      const T* aL = nullptr;
+      const T* aR = nullptr;
+      source(src, aL, aR);
+      if (!aL) continue;
+      if (!L) {
+        memcpy(sL, aL, sizeof(T) * n);
+        memcpy(sR, aR, sizeof(T) * n);
+        L = sL;
+        R = sR;
+        continue;
+      }
+      for (int i = 0; i < n; i++) {
+        sL[i] += aL[i];
+        sR[i] += aR[i];
+      }
+    }
+  }
+  // Run a float‑only node inside a double precision plan, converting
+  // its input and output.
+  static int32_t runNarrow(NarrowBuffers& nb, Node& node, const double* inL, const double* inR,
+                           double* outL, double* outR, int n) {
+    float* L = nullptr;
+    float* R = nullptr;
+    if (inL) convertSamples(inL, L = nb.in.L.data(), n);
+    if (inR) convertSamples(inR, R = nb.in.R.data(), n);
+    const int32_t r = node.process(L, R, nb.out.L.data(), nb.out.R.data(), n);
+    if (r == 1) {
+      convertSamples(nb.out.L.data(), outL, n);
+      convertSamples(nb.out.R.data(), outR, n);
+    }
+    return r;
+  }
+  // Render a single step: resolve its inputs and run the node into its
+  // buffer, or for the graph output into the caller's buffers when
+  // io.direct is set. Pass‑through steps only point their view at
+  // their input. Buffer assignment guarantees that steps without a
+  // dependency never share a buffer, so they may run in parallel.
+  //
+  // A node whose input stays silent is put to sleep once its tail has
+  // passed and its output is silent too; while it sleeps the step
+  // only marks its view silent. Non‑silent input or a queued event
+  // wakes it for the current block.
+  template <typename T>
+  void runStep(RenderPlan& p, const PlanStep& st, const BlockIO<T>& io) {
+    Node& node = *st.node;
+    PlanBuffers<T>& bufs = p.bufs<T>();
+    BufferView<T>& view = bufs.views[st.out];
+    const int n = io.n;
+    const T* srcL = nullptr;
+    const T* srcR = nullptr;
+    bool silentIn = true;
+    if (st.multiBus) {
+      for (int b = 0; b < node.inputBusCount(); ++b) setNodeInput(node, b, (const T*)nullptr, (const T*)nullptr);
+    }
+    for (const auto& in : st.inputs) {
+      const T* L = nullptr;
+      const T* R = nullptr;
+      gather(p, in, io.inL, io.inR, n, L, R);
+      if (L) silentIn = false;
+      if (in.bus == 0) {
+        srcL = L;
+        srcR = R;
+      }
+      if (st.multiBus) setNodeInput(node, in.bus, L, R);
+    }
+    if (st.alias) {
+      view.L = srcL;
+      view.R = srcR;
+      return;
+    }
+    int32_t wake = node.wakeFor.load(std::memory_order_relaxed);
+    if (wake > 0) wake = node.wakeFor.exchange(0, std::memory_order_acquire);
+    node.awakeFor = std::max(node.awakeFor, wake);
+    if (silentIn && node.awakeFor <= 0 && node.asleep.load(std::memory_order_relaxed)) {
+      view = BufferView<T>{};
+      return;
+    }
+    const bool direct = io.direct && st.out == p.ioOut;
+    T* outL = direct ? io.outL : bufs.pool[st.buf].L.data();
+    T* outR = direct ? io.outR : bufs.pool[st.buf].R.data();
+    int32_t r;
+    if constexpr (std::is_same<T, double>::value) {
+      r = st.narrow >= 0 ? runNarrow(p.narrow[st.narrow], node, srcL, srcR, outL, outR, n)
+                         : runNode(node, srcL, srcR, outL, outR, n);
+    } else {
+      r = runNode(node, srcL, srcR, outL, outR, n);
+    }
+    if (r != 1) {
+      memset(outL, 0, sizeof(T) * n);
+      memset(outR, 0, sizeof(T) * n);
+    }
+    const bool silent = silentIn && (r != 1 || node.outputSilent() || isQuiet(outL, outR, n));
+    view.L = silent ? nullptr : outL;
+    view.R = silent ? nullptr : outR;
+    node.quietFor = silentIn && node.awakeFor <= 0 ? node.quietFor + n : 0;
+    node.awakeFor = std::max(0, node.awakeFor - n);
+    node.asleep.store(silent && st.tail >= 0 && node.quietFor > st.tail, std::memory_order_relaxed);
+  }
+  // State shared by the participants of one parallel block. Lives on
+  // the audio thread's stack for the duration of RenderPool::run().
+  template <typename T>
+  struct BlockJob {
+    GraphImpl* graph;
+    RenderPlan* plan;
+    BlockIO<T> io;
+  };
+  template <typename T>
+  static void renderTask(void* ctx, int participant) {
+    auto* j = (BlockJob<T>*)ctx;
+    j->graph->drain(*j->plan, participant, j->io);
+  }
+  // Run ready steps until the block is complete. Each participant pops
+  // from its own queue and steals from the others when it runs dry. A
+  // finished step decrements the counters of its dependents and queues
+  // those that become ready. Every buffer has exactly one writer and
+  // sums are accumulated in a fixed order, so the result does not
+  // depend on which thread ran which step.
+  template <typename T>
+  void drain(RenderPlan& p, int who, const BlockIO<T>& io) {
+    const int parts = p.pool->participants();
+    WorkQueue& own = p.queues[who];
+    int spins = 0;
+    while (p.remaining.load(std::memory_order_acquire) > 0) {
+      int k = -1;
+      bool got = own.pop(k);
+      for (int i = 1; !got && i < parts; ++i) got = p.queues[(who + i) % parts].steal(k);
+      if (!got) {
+        backoff(spins);
+        continue;
+      }
+      spins = 0;
+      runStep(p, p.steps[k], io);
+      for (int d : p.dependents[k])
+        if (p.pending[d].fetch_sub(1, std::memory_order_acq_rel) == 1) own.push(d);
+      p.remaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+  }
+  // Render one block of at most maxBlock frames with a pinned plan. T
+  // must be the plan's sample type. Plan buffers are sized to
+  // maxBlock. Node outputs are overwritten every block so no clearing
+  // is needed.
+  template <typename T>
+  void renderBlock(RenderPlan& p, const T* inL, const T* inR, T* outL, T* outR, int n) {
+    // Host input that is silent is read as nullptr so silence can
+    // propagate from the graph input.
+    if (inL && inR && isQuiet(inL, inR, n)) inL = inR = nullptr;
+    // The output node renders straight into the caller's buffers
+    // unless they overlap the input, which later steps may still read.
+    auto overlaps = [n](const T* a, const T* b) { return a && b && a < b + n && b < a + n; };
+    BlockIO<T> io{inL, inR, outL, outR, n, false};
+    io.direct = p.ioOut >= 0 && p.ioOut != p.ioIn && !overlaps(outL, outR) && !overlaps(outL, inL) &&
+                !overlaps(outL, inR) && !overlaps(outR, inL) && !overlaps(outR, inR);
+    if (p.pool && !p.steps.empty()) {
+      const int steps = (int)p.steps.size();
+      const int parts = p.pool->participants();
+      for (int k = 0; k < steps; ++k) p.pending[k].store(p.indegree[k], std::memory_order_relaxed);
+      for (int t = 0; t < parts; ++t) p.queues[t].head = p.queues[t].tail = 0;
+      for (size_t r = 0; r < p.roots.size(); ++r) p.queues[r % parts].push(p.roots[r]);
+      p.remaining.store(steps);
+      BlockJob<T> job{this, &p, io};
+      p.pool->run(&GraphImpl::renderTask<T>, &job);
+    } else {
+      for (const auto& st : p.steps) runStep(p, st, io);
+    }
+    BufferView<T> out;
+    if (p.ioOut >= 0) out = p.ioOut == p.ioIn ? BufferView<T>{inL, inR} : p.bufs<T>().views[p.ioOut];
+    if (!out.L) {
+      memset(outL, 0, sizeof(T) * n);
+      memset(outR, 0, sizeof(T) * n);
+      return;
+    }
+    if (out.L != outL) memmove(outL, out.L, sizeof(T) * n);
+    if (out.R != outR) memmove(outR, out.R, sizeof(T) * n);
+  }
+  template <typename T>
+  const T* zeros() const {
+    if constexpr (std::is_same<T, double>::value) return silence64.data(); else return silence.data();
+  }
+  // Split a host block of any size into maxBlock slices. Null inputs
+  // read as silence.
+  template <typename T>
+  void processChunked(RenderPlan& p, const T* inL, const T* inR, T* outL, T* outR, int n) {
+    for (int pos = 0; pos < n; pos += maxBlock) {
+      const int len = std::min(maxBlock, n - pos);
+      renderBlock(p, inL ? inL + pos : zeros<T>(), inR ? inR + pos : zeros<T>(),
+                  outL + pos, outR + pos, len);
+    }
+  }
+  // Fixed‑quantum mode: append the host block to the input FIFO, read
+  // the same number of frames from the output FIFO and render a whole
+  // quantum each time the input FIFO fills up.
+  template <typename T>
+  void processQuantized(RenderPlan& p, const T* inL, const T* inR, T* outL, T* outR, int n) {
+    BlockQuantizer& q = *p.quantizer;
+    PlanBuffer<T>& qin = q.input<T>();
+    PlanBuffer<T>& qout = q.output<T>();
+    int fill = q.fill.load(std::memory_order_relaxed);
+    for (int pos = 0; pos < n;) {
+      const int len = std::min(q.quantum - fill, n - pos);
+      if (inL) memcpy(qin.L.data() + fill, inL + pos, sizeof(T) * len);
+      else memset(qin.L.data() + fill, 0, sizeof(T) * len);
+      if (inR) memcpy(qin.R.data() + fill, inR + pos, sizeof(T) * len);
+      else memset(qin.R.data() + fill, 0, sizeof(T) * len);
+      memcpy(outL + pos, qout.L.data() + fill, sizeof(T) * len);
+      memcpy(outR + pos, qout.R.data() + fill, sizeof(T) * len);
+      fill += len;
+      pos += len;
+      if (fill == q.quantum) {
+        renderBlock(p, qin.L.data(), qin.R.data(), qout.L.data(), qout.R.data(), q.quantum);
+        fill = 0;
+      }
+    }
+    q.fill.store(fill, std::memory_order_relaxed);
+  }
+  // Call fn(L, R, outL, outR, n) with buffers of the plan's sample
+  // type. Host buffers of that type are passed through; otherwise the
+  // block is converted in maxBlock slices through the plan's IO
+  // buffers, so conversion happens once at the graph boundary.
+  template <typename T, typename Fn>
+  void withPlanType(RenderPlan& p, const T* inL, const T* inR, T* outL, T* outR, int n, Fn&& fn) {
+    if (p.wide == std::is_same<T, double>::value) {
+      fn(inL, inR, outL, outR, n);
+    } else if (p.wide) {
+      convertThrough(p.buffers64, inL, inR, outL, outR, n, fn);
+    } else {
+      convertThrough(p.buffers, inL, inR, outL, outR, n, fn);
+    }
+  }
+  template <typename U, typename T, typename Fn>
+  void convertThrough(PlanBuffers<U>& b, const T* inL, const T* inR, T* outL, T* outR, int n, Fn& fn) {
+    if constexpr (!std::is_same<T, U>::value) {
+      for (int pos = 0; pos < n; pos += maxBlock) {
+        const int len = std::min(maxBlock, n - pos);
+        const U* L = nullptr;
+        const U* R = nullptr;
+        if (inL) convertSamples(inL + pos, b.ioIn.L.data(), len), L = b.ioIn.L.data();
+        if (inR) convertSamples(inR + pos, b.ioIn.R.data(), len), R = b.ioIn.R.data();
+        fn(L, R, b.ioOut.L.data(), b.ioOut.R.data(), len);
+        convertSamples(b.ioOut.L.data(), outL + pos, len);
+        convertSamples(b.ioOut.R.data(), outR + pos, len);
+      }
+    }
+  }
+  // Render a host block of any size using the current plan. Never
+  // allocates.
+  template <typename T>
+  int process(const T* inL, const T* inR, T* outL, T* outR, int n) {
+    if (n <= 0 || !outL || !outR) return 0;
+    int slot = 0;
+    RenderPlan& p = *acquire(slot);
+    withPlanType(p, inL, inR, outL, outR, n, [&](auto* L, auto* R, auto* oL, auto* oR, int len) {
+      if (p.quantizer) processQuantized(p, L, R, oL, oR, len);
+      else processChunked(p, L, R, oL, oR, len);
+    });
+    release(slot);
     return 1;
   }
 };
@@ -235,13 +1692,7 @@ void dvh_graph_destroy(DVH_Graph g) {
 }
 int32_t dvh_graph_clear(DVH_Graph g) {
   if (!g) return 0;
-  auto* gg = (GraphImpl*)g;
-  std::lock_guard<std::mutex> lk(gg->editMtx);
-  gg->nodes.clear();
-  gg->edges.clear();
-  gg->ioIn = -1;
-  gg->ioOut = -1;
-  return 1;
+  return ((GraphImpl*)g)->clear();
 }
 
 int32_t dvh_graph_add_vst(DVH_Graph g, const char* path, const char* uid, int32_t* out_id) {
@@ -253,15 +1704,31 @@ int32_t dvh_graph_add_vst(DVH_Graph g, const char* path, const char* uid, int32_
     dvh_unload_plugin(p);
     return 0;
   }
-  int id = gg->addNode(std::make_unique<VstNode>(p));
+  int id = gg->addNode(std::make_shared<VstNode>(p));
   if (out_id) *out_id = id;
   return 1;
 }
 
+int32_t dvh_graph_add_vst_async(DVH_Graph g, const char* path, const char* uid) {
+  if (!g || !path) return 0;
+  return ((GraphImpl*)g)->requestLoad(path, uid);
+}
+int32_t dvh_graph_poll_vst(DVH_Graph g, int32_t request, int32_t* out_id) {
+  if (!g) return DVH_LOAD_FAILED;
+  int id = -1;
+  int status = ((GraphImpl*)g)->pollLoad(request, &id);
+  if (status == DVH_LOAD_DONE && out_id) *out_id = id;
+  return status;
+}
+int32_t dvh_graph_load_progress(DVH_Graph g, int32_t* done, int32_t* total) {
+  if (!g) return 0;
+  return ((GraphImpl*)g)->loadProgress(done, total);
+}
+
 int32_t dvh_graph_add_mixer(DVH_Graph g, int32_t nin, int32_t* out_id) {
   if (!g || nin <= 0) return 0;
   auto* gg = (GraphImpl*)g;
-  int id = gg->addNode(std::make_unique<MixerNode>(nin));
+  int id = gg->addNode(std::make_shared<MixerNode>(nin));
   if (out_id) *out_id = id;
   return 1;
 }
@@ -269,7 +1736,7 @@ int32_t dvh_graph_add_mixer(DVH_Graph g, int32_t nin, int32_t* out_id) {
 int32_t dvh_graph_add_split(DVH_Graph g, int32_t* out_id) {
   if (!g) return 0;
   auto* gg = (GraphImpl*)g;
-  int id = gg->addNode(std::make_unique<SplitNode>());
+  int id = gg->addNode(std::make_shared<SplitNode>());
   if (out_id) *out_id = id;
   return 1;
 }
@@ -277,61 +1744,73 @@ int32_t dvh_graph_add_split(DVH_Graph g, int32_t* out_id) {
 int32_t dvh_graph_add_gain(DVH_Graph g, float db, int32_t* out_id) {
   if (!g) return 0;
   auto* gg = (GraphImpl*)g;
-  int id = gg->addNode(std::make_unique<GainNode>(db));
+  int id = gg->addNode(std::make_shared<GainNode>(db));
   if (out_id) *out_id = id;
   return 1;
 }
 
+int32_t dvh_graph_remove_node(DVH_Graph g, int32_t node) {
+  if (!g) return 0;
+  return ((GraphImpl*)g)->removeNode(node);
+}
+
 int32_t dvh_graph_connect(DVH_Graph g, int32_t s, int32_t sb, int32_t d, int32_t db) {
-  (void)sb; (void)db;
   if (!g) return 0;
   auto* gg = (GraphImpl*)g;
-  return gg->setEdge(s, d);
+  return gg->setEdge(Conn{s, sb, d, db});
 }
 int32_t dvh_graph_disconnect(DVH_Graph g, int32_t s, int32_t sb, int32_t d, int32_t db) {
-  (void)sb; (void)db;
   if (!g) return 0;
   auto* gg = (GraphImpl*)g;
-  return gg->clearEdge(s, d);
+  return gg->clearEdge(Conn{s, sb, d, db});
 }
 int32_t dvh_graph_set_io_nodes(DVH_Graph g, int32_t in, int32_t out) {
   if (!g) return 0;
-  auto* gg = (GraphImpl*)g;
-  gg->ioIn = in;
-  gg->ioOut = out;
-  return 1;
+  return ((GraphImpl*)g)->setIO(in, out);
 }
 
-int32_t dvh_graph_note_on(DVH_Graph g, int32_t node, int32_t ch, int32_t note, float vel) {
-  if (!g) return 0;
+// Wake a node for an event it accepted, so that a sleeping node
+// processes the block the event falls in.
+static int32_t wakeAfter(Node& n, int32_t offset, int32_t accepted) {
+  if (accepted == 1) n.wake(offset);
+  return accepted;
+}
+
+int32_t dvh_graph_note_on_at(DVH_Graph g, int32_t node, int32_t offset, int32_t ch, int32_t note, float vel) {
+  if (!g || offset < 0) return 0;
   auto* gg = (GraphImpl*)g;
-  if (node >= 0 && node < (int)gg->nodes.size())
-    return gg->nodes[node]->noteOn(ch, note, vel);
-  for (auto& n : gg->nodes) n->noteOn(ch, note, vel);
+  offset = gg->eventOffset(offset);
+  if (node >= 0)
+    return gg->withNode(node, 0, [&](Node& n) { return wakeAfter(n, offset, n.noteOn(offset, ch, note, vel)); });
+  gg->forEachNode([&](Node& n) { wakeAfter(n, offset, n.noteOn(offset, ch, note, vel)); });
   return 1;
 }
-int32_t dvh_graph_note_off(DVH_Graph g, int32_t node, int32_t ch, int32_t note, float vel) {
-  if (!g) return 0;
+int32_t dvh_graph_note_off_at(DVH_Graph g, int32_t node, int32_t offset, int32_t ch, int32_t note, float vel) {
+  if (!g || offset < 0) return 0;
   auto* gg = (GraphImpl*)g;
-  if (node >= 0 && node < (int)gg->nodes.size())
-    return gg->nodes[node]->noteOff(ch, note, vel);
-  for (auto& n : gg->nodes) n->noteOff(ch, note, vel);
+  offset = gg->eventOffset(offset);
+  if (node >= 0)
+    return gg->withNode(node, 0, [&](Node& n) { return wakeAfter(n, offset, n.noteOff(offset, ch, note, vel)); });
+  gg->forEachNode([&](Node& n) { wakeAfter(n, offset, n.noteOff(offset, ch, note, vel)); });
   return 1;
 }
+int32_t dvh_graph_note_on(DVH_Graph g, int32_t node, int32_t ch, int32_t note, float vel) {
+  return dvh_graph_note_on_at(g, node, 0, ch, note, vel);
+}
+int32_t dvh_graph_note_off(DVH_Graph g, int32_t node, int32_t ch, int32_t note, float vel) {
+  return dvh_graph_note_off_at(g, node, 0, ch, note, vel);
+}
 
 int32_t dvh_graph_param_count(DVH_Graph g, int32_t node) {
   if (!g) return 0;
-  auto* gg = (GraphImpl*)g;
-  if (node < 0 || node >= (int)gg->nodes.size()) return 0;
-  return gg->nodes[node]->paramCount();
+  return ((GraphImpl*)g)->withNode(node, 0, [](Node& n) { return n.paramCount(); });
 }
 int32_t dvh_graph_param_info(DVH_Graph g, int32_t node, int32_t idx, int32_t* id, char* t, int32_t tcap, char* u, int32_t ucap) {
   if (!g) return 0;
   auto* gg = (GraphImpl*)g;
-  if (node < 0 || node >= (int)gg->nodes.size()) return 0;
   std::string ts, us;
   int32_t pid = 0;
-  if (!gg->nodes[node]->paramInfo(idx, &pid, ts, us)) return 0;
+  if (!gg->withNode(node, 0, [&](Node& n) { return n.paramInfo(idx, &pid, ts, us); })) return 0;
   if (id) *id = pid;
   auto cpy = [&](const std::string& s, char* o, int32_t cap) {
     if (!o || cap <= 0) return;
@@ -346,15 +1825,16 @@ int32_t dvh_graph_param_info(DVH_Graph g, int32_t node, int32_t idx, int32_t* id
 }
 float dvh_graph_get_param(DVH_Graph g, int32_t node, int32_t id) {
   if (!g) return 0;
+  return ((GraphImpl*)g)->withNode(node, 0.f, [&](Node& n) { return n.getParam(id); });
+}
+int32_t dvh_graph_set_param_at(DVH_Graph g, int32_t node, int32_t id, int32_t offset, float v) {
+  if (!g || offset < 0) return 0;
   auto* gg = (GraphImpl*)g;
-  if (node < 0 || node >= (int)gg->nodes.size()) return 0;
-  return gg->nodes[node]->getParam(id);
+  offset = gg->eventOffset(offset);
+  return gg->withNode(node, 0, [&](Node& n) { return wakeAfter(n, offset, n.setParam(id, offset, v)); });
 }
 int32_t dvh_graph_set_param(DVH_Graph g, int32_t node, int32_t id, float v) {
-  if (!g) return 0;
-  auto* gg = (GraphImpl*)g;
-  if (node < 0 || node >= (int)gg->nodes.size()) return 0;
-  return gg->nodes[node]->setParam(id, v);
+  return dvh_graph_set_param_at(g, node, id, 0, v);
 }
 
 int32_t dvh_graph_set_transport(DVH_Graph g, DVH_Transport t) {
@@ -362,14 +1842,124 @@ int32_t dvh_graph_set_transport(DVH_Graph g, DVH_Transport t) {
   ((GraphImpl*)g)->transport = t;
   return 1;
 }
+int32_t dvh_graph_set_block_quantum(DVH_Graph g, int32_t frames) {
+  if (!g) return 0;
+  return ((GraphImpl*)g)->setBlockQuantum(frames);
+}
+int32_t dvh_graph_set_thread_count(DVH_Graph g, int32_t threads) {
+  if (!g) return 0;
+  return ((GraphImpl*)g)->setThreadCount(threads);
+}
+int32_t dvh_graph_is_sleeping(DVH_Graph g, int32_t node) {
+  if (!g) return 0;
+  return ((GraphImpl*)g)->withNode(node, 0, [](Node& n) { return n.asleep.load(std::memory_order_relaxed) ? 1 : 0; });
+}
 int32_t dvh_graph_latency(DVH_Graph g) {
   if (!g) return 0;
-  return 0;
+  return ((GraphImpl*)g)->totalLatency();
 }
 
 int32_t dvh_graph_process_stereo(DVH_Graph g, const float* inL, const float* inR, float* outL, float* outR, int32_t n) {
   if (!g) return 0;
+#ifdef DVH_GRAPH_TRACK_ALLOCATIONS
+  t_inProcess = true;
+  int32_t r = ((GraphImpl*)g)->process(inL, inR, outL, outR, n);
+  t_inProcess = false;
+  return r;
+#else
+  return ((GraphImpl*)g)->process(inL, inR, outL, outR, n);
+#endif
+}
+
+int32_t dvh_graph_process_stereo_f64(DVH_Graph g, const double* inL, const double* inR,
+                                     double* outL, double* outR, int32_t n) {
+  if (!g) return 0;
+#ifdef DVH_GRAPH_TRACK_ALLOCATIONS
+  t_inProcess = true;
+  int32_t r = ((GraphImpl*)g)->process(inL, inR, outL, outR, n);
+  t_inProcess = false;
+  return r;
+#else
   return ((GraphImpl*)g)->process(inL, inR, outL, outR, n);
+#endif
+}
+
+int32_t dvh_graph_set_double_precision(DVH_Graph g, int32_t enable) {
+  if (!g) return 0;
+  return ((GraphImpl*)g)->setDoublePrecision(enable != 0);
+}
+
+int32_t dvh_graph_render_offline(DVH_Graph g, const float* inL, const float* inR,
+                                 float* outL, float* outR, int64_t num_frames,
+                                 double* samples_per_second) {
+  if (!g) return 0;
+  auto* gg = (GraphImpl*)g;
+  std::vector<float> silence;
+  if (!inL || !inR) silence.assign(gg->maxBlock, 0);
+  return gg->renderOffline(
+      [&](int64_t pos, int, const float*& L, const float*& R) {
+        L = inL ? inL + pos : silence.data();
+        R = inR ? inR + pos : silence.data();
+      },
+      outL, outR, num_frames, samples_per_second);
+}
+
+int32_t dvh_graph_render_offline_f64(DVH_Graph g, const double* inL, const double* inR,
+                                     double* outL, double* outR, int64_t num_frames,
+                                     double* samples_per_second) {
+  if (!g) return 0;
+  auto* gg = (GraphImpl*)g;
+  std::vector<double> silence;
+  if (!inL || !inR) silence.assign(gg->maxBlock, 0);
+  return gg->renderOffline(
+      [&](int64_t pos, int, const double*& L, const double*& R) {
+        L = inL ? inL + pos : silence.data();
+        R = inR ? inR + pos : silence.data();
+      },
+      outL, outR, num_frames, samples_per_second);
+}
+
+int32_t dvh_graph_render_offline_source(DVH_Graph g, DVH_RenderSource source, void* user,
+                                        float* outL, float* outR, int64_t num_frames,
+                                        double* samples_per_second) {
+  if (!g || !source) return 0;
+  auto* gg = (GraphImpl*)g;
+  std::vector<float> bufL(gg->maxBlock), bufR(gg->maxBlock);
+  return gg->renderOffline(
+      [&](int64_t pos, int n, const float*& L, const float*& R) {
+        std::fill(bufL.begin(), bufL.begin() + n, 0.f);
+        std::fill(bufR.begin(), bufR.begin() + n, 0.f);
+        source(user, pos, bufL.data(), bufR.data(), n);
+        L = bufL.data();
+        R = bufR.data();
+      },
+      outL, outR, num_frames, samples_per_second);
+}
+
+int32_t dvh_graph_debug_buffer_count(DVH_Graph g) {
+  if (!g) return 0;
+  auto* gg = (GraphImpl*)g;
+  int slot = 0;
+  RenderPlan* p = gg->acquire(slot);
+  const int32_t n = (int32_t)(p->wide ? p->buffers64.pool.size() : p->buffers.pool.size());
+  gg->release(slot);
+  return n;
+}
+
+int32_t dvh_graph_debug_add_delay(DVH_Graph g, int32_t frames, int32_t* out_id) {
+  if (!g || frames < 1) return 0;
+  auto* gg = (GraphImpl*)g;
+  int id = gg->addNode(std::make_shared<DelayNode>(frames));
+  if (out_id) *out_id = id;
+  return 1;
+}
+
+int64_t dvh_graph_debug_alloc_count(void) {
+#ifdef DVH_GRAPH_TRACK_ALLOCATIONS
+  return g_processAllocs.load();
+#else
+  return -1;
+#endif
 }
 
 } // extern "C"
\ No newline at end of file
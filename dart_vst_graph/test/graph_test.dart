@@ -1,4 +1,5 @@
 import 'dart:io';
+import 'dart:typed_data';
 import 'package:test/test.dart';
 import 'package:dart_vst_graph/dart_vst_graph.dart';
 
@@ -30,4 +31,405 @@ void main() {
     // The GainNode has exactly one parameter at index 0
     expect(graph.setParam(id, 0, 0.5), isTrue);
   });
-}
\ No newline at end of file
+
+  test('processing does not allocate', () {
+    final before = graph.debugAllocationCount();
+    if (before < 0) {
+      markTestSkipped('native library built without DVH_GRAPH_TRACK_ALLOCATIONS');
+      return;
+    }
+    final input = graph.addSplit();
+    final gain = graph.addGain(-6.0);
+    final output = graph.addSplit();
+    expect(graph.connect(input, gain), isTrue);
+    expect(graph.connect(gain, output), isTrue);
+    expect(graph.setIO(inputNode: input, outputNode: output), isTrue);
+
+    final inL = Float32List(64)..fillRange(0, 64, 0.5);
+    final inR = Float32List(64)..fillRange(0, 64, 0.5);
+    final outL = Float32List(64);
+    final outR = Float32List(64);
+    final start = graph.debugAllocationCount();
+    for (var i = 0; i < 100; i++) {
+      expect(graph.process(inL, inR, outL, outR), isTrue);
+    }
+    expect(graph.debugAllocationCount(), equals(start));
+    expect(outL[0], closeTo(0.5 * 0.501, 0.001));
+  });
+
+  test('connect rejects cycles', () {
+    final a = graph.addGain(0.0);
+    final b = graph.addGain(0.0);
+    final c = graph.addGain(0.0);
+    expect(graph.connect(a, b), isTrue);
+    expect(graph.connect(b, c), isTrue);
+    expect(graph.connect(c, a), isFalse);
+    expect(graph.connect(a, a), isFalse);
+    expect(graph.disconnect(a, b), isTrue);
+    expect(graph.connect(c, a), isTrue);
+  });
+
+  test('nodes run after their sources regardless of insertion order', () {
+    // The output node is created before the node feeding it.
+    final output = graph.addSplit();
+    final gain = graph.addGain(-6.0);
+    final input = graph.addSplit();
+    expect(graph.connect(input, gain), isTrue);
+    expect(graph.connect(gain, output), isTrue);
+    expect(graph.setIO(inputNode: input, outputNode: output), isTrue);
+
+    final inL = Float32List(64)..fillRange(0, 64, 1.0);
+    final inR = Float32List(64)..fillRange(0, 64, 1.0);
+    final outL = Float32List(64);
+    final outR = Float32List(64);
+    expect(graph.process(inL, inR, outL, outR), isTrue);
+    expect(outL[0], closeTo(0.501, 0.001));
+    expect(outR[63], closeTo(0.501, 0.001));
+  });
+
+  test('removed nodes are dropped from the schedule', () {
+    final input = graph.addSplit();
+    final gain = graph.addGain(-6.0);
+    final output = graph.addSplit();
+    expect(graph.connect(input, gain), isTrue);
+    expect(graph.connect(gain, output), isTrue);
+    expect(graph.setIO(inputNode: input, outputNode: output), isTrue);
+    expect(graph.removeNode(gain), isTrue);
+    expect(graph.removeNode(gain), isFalse);
+    expect(graph.setParam(gain, 0, 0.5), isFalse);
+    expect(graph.connect(input, output), isTrue);
+
+    final inL = Float32List(64)..fillRange(0, 64, 1.0);
+    final inR = Float32List(64)..fillRange(0, 64, 1.0);
+    final outL = Float32List(64);
+    final outR = Float32List(64);
+    expect(graph.process(inL, inR, outL, outR), isTrue);
+    expect(outL[0], closeTo(1.0, 1e-6));
+  });
+
+  test('fan-in sums sources and mixers use bus indices', () {
+    final input = graph.addSplit();
+    final a = graph.addGain(0.0);
+    final b = graph.addGain(-6.0);
+    final mixer = graph.addMixer(2);
+    final sum = graph.addSplit();
+    final output = graph.addSplit();
+    expect(graph.connect(input, a), isTrue);
+    expect(graph.connect(input, b), isTrue);
+    expect(graph.connect(a, mixer, dstBus: 0), isTrue);
+    expect(graph.connect(b, mixer, dstBus: 1), isTrue);
+    expect(graph.connect(b, mixer, dstBus: 2), isFalse);
+    expect(graph.connect(a, mixer, srcBus: 1, dstBus: 1), isFalse);
+    expect(graph.connect(a, sum), isTrue);
+    expect(graph.connect(mixer, sum), isTrue);
+    expect(graph.connect(mixer, sum), isFalse);
+    expect(graph.connect(sum, output), isTrue);
+    expect(graph.setIO(inputNode: input, outputNode: output), isTrue);
+
+    final inL = Float32List(64)..fillRange(0, 64, 1.0);
+    final inR = Float32List(64)..fillRange(0, 64, 1.0);
+    final outL = Float32List(64);
+    final outR = Float32List(64);
+    expect(graph.process(inL, inR, outL, outR), isTrue);
+    // sum = a + (a + b) = 1 + 1 + 0.501
+    expect(outL[0], closeTo(2.501, 0.001));
+    expect(outR[63], closeTo(2.501, 0.001));
+  });
+
+  test('one-input mixers hear their source', () {
+    final input = graph.addSplit();
+    final mixer = graph.addMixer(1);
+    expect(graph.connect(input, mixer), isTrue);
+    expect(graph.setIO(inputNode: input, outputNode: mixer), isTrue);
+
+    final inL = Float32List(64)..fillRange(0, 64, 0.5);
+    final inR = Float32List(64)..fillRange(0, 64, 0.5);
+    final outL = Float32List(64);
+    final outR = Float32List(64);
+    expect(graph.process(inL, inR, outL, outR), isTrue);
+    expect(outL[0], closeTo(0.5, 1e-6));
+    expect(outR[63], closeTo(0.5, 1e-6));
+  });
+
+  test('failed background loads are reported', () async {
+    final request = graph.addVstAsync('/nonexistent/plugin.vst3');
+    while (graph.loadProgress().done < 1) {
+      await Future<void>.delayed(const Duration(milliseconds: 5));
+    }
+    expect(() => graph.pollVst(request), throwsStateError);
+    expect(graph.loadProgress(), (done: 1, total: 1));
+    await expectLater(graph.loadVst('/nonexistent/plugin.vst3'), throwsStateError);
+  });
+
+  test('parallel rendering matches serial rendering', () {
+    final libPath = Directory.current.path + Platform.pathSeparator + libFile.path;
+    VstGraph build(int threads) {
+      final g = VstGraph(sampleRate: 48000, maxBlock: 512, dylibPath: libPath);
+      expect(g.setThreadCount(threads), isTrue);
+      final input = g.addSplit();
+      final output = g.addSplit();
+      for (var c = 0; c < 16; c++) {
+        var prev = input;
+        for (var d = 0; d < 4; d++) {
+          final gain = g.addGain(-0.5 * (c % 5));
+          expect(g.connect(prev, gain), isTrue);
+          prev = gain;
+        }
+        expect(g.connect(prev, output), isTrue);
+      }
+      expect(g.setIO(inputNode: input, outputNode: output), isTrue);
+      return g;
+    }
+
+    expect(graph.setThreadCount(0), isFalse);
+    final serial = build(1);
+    final parallel = build(4);
+    final inL = Float32List.fromList(List.generate(512, (i) => (i % 32) / 32.0));
+    final inR = Float32List.fromList(List.generate(512, (i) => 1.0 - (i % 16) / 16.0));
+    final sL = Float32List(512), sR = Float32List(512);
+    final pL = Float32List(512), pR = Float32List(512);
+    for (var block = 0; block < 8; block++) {
+      expect(serial.process(inL, inR, sL, sR), isTrue);
+      expect(parallel.process(inL, inR, pL, pR), isTrue);
+      expect(pL, equals(sL));
+      expect(pR, equals(sR));
+    }
+    serial.dispose();
+    parallel.dispose();
+  });
+
+  test('graph without plug-ins has no latency', () {
+    final input = graph.addSplit();
+    final gain = graph.addGain(0.0);
+    final output = graph.addSplit();
+    expect(graph.connect(input, gain), isTrue);
+    expect(graph.connect(gain, output), isTrue);
+    expect(graph.connect(input, output), isTrue);
+    expect(graph.setIO(inputNode: input, outputNode: output), isTrue);
+    expect(graph.latency(), equals(0));
+
+    final inL = Float32List(64)..[5] = 1.0;
+    final inR = Float32List(64)..[5] = 1.0;
+    final outL = Float32List(64);
+    final outR = Float32List(64);
+    expect(graph.process(inL, inR, outL, outR), isTrue);
+    expect(outL[5], closeTo(2.0, 1e-6));
+    expect(outL[4], equals(0.0));
+  });
+
+  test('gain changes are applied at their sample offset', () {
+    final input = graph.addSplit();
+    final gain = graph.addGain(0.0);
+    expect(graph.connect(input, gain), isTrue);
+    expect(graph.setIO(inputNode: input, outputNode: gain), isTrue);
+    // ‑60 dB at frame 100, back to 0 dB at frame 300
+    expect(graph.setParam(gain, 0, 0.0, sampleOffset: 100), isTrue);
+    expect(graph.setParam(gain, 0, 1.0, sampleOffset: 300), isTrue);
+    expect(graph.setParam(gain, 0, 0.5, sampleOffset: -1), isFalse);
+
+    final inL = Float32List(512)..fillRange(0, 512, 1.0);
+    final inR = Float32List(512)..fillRange(0, 512, 1.0);
+    final outL = Float32List(512);
+    final outR = Float32List(512);
+    expect(graph.process(inL, inR, outL, outR), isTrue);
+    expect(outL[99], closeTo(1.0, 1e-6));
+    expect(outL[100], closeTo(0.001, 1e-6));
+    expect(outR[299], closeTo(0.001, 1e-6));
+    expect(outR[300], closeTo(1.0, 1e-6));
+  });
+
+  test('offline render processes buffers longer than maxBlock', () {
+    final input = graph.addSplit();
+    final gain = graph.addGain(-6.0206);
+    expect(graph.connect(input, gain), isTrue);
+    expect(graph.setIO(inputNode: input, outputNode: gain), isTrue);
+
+    const n = 48000;
+    final inL = Float32List.fromList(List.generate(n, (i) => (i % 100) / 100.0));
+    final inR = Float32List.fromList(List.generate(n, (i) => 1.0 - (i % 50) / 50.0));
+    final outL = Float32List(n);
+    final outR = Float32List(n);
+    final samplesPerSecond = graph.renderOffline(inL, inR, outL, outR);
+    expect(samplesPerSecond, greaterThan(0));
+    for (final i in [0, 511, 512, 12345, n - 1]) {
+      expect(outL[i], closeTo(inL[i] * 0.5, 1e-4));
+      expect(outR[i], closeTo(inR[i] * 0.5, 1e-4));
+    }
+
+    graph.renderOffline(null, null, outL, outR);
+    expect(outL.every((v) => v == 0), isTrue);
+  });
+
+  test('blocks larger than maxBlock are split with exact event timing', () {
+    final input = graph.addSplit();
+    final gain = graph.addGain(0.0);
+    expect(graph.connect(input, gain), isTrue);
+    expect(graph.setIO(inputNode: input, outputNode: gain), isTrue);
+    expect(graph.setParam(gain, 0, 0.0, sampleOffset: 1300), isTrue);
+
+    final inL = Float32List(2000)..fillRange(0, 2000, 1.0);
+    final inR = Float32List(2000)..fillRange(0, 2000, 1.0);
+    final outL = Float32List(2000);
+    final outR = Float32List(2000);
+    expect(graph.process(inL, inR, outL, outR), isTrue);
+    expect(outL[1299], closeTo(1.0, 1e-6));
+    expect(outL[1300], closeTo(0.001, 1e-6));
+    expect(outR[1999], closeTo(0.001, 1e-6));
+  });
+
+  test('fixed quantum mode delays output by one quantum', () {
+    final input = graph.addSplit();
+    final output = graph.addSplit();
+    expect(graph.connect(input, output), isTrue);
+    expect(graph.setIO(inputNode: input, outputNode: output), isTrue);
+    expect(graph.setBlockQuantum(1024), isFalse);
+    expect(graph.setBlockQuantum(128), isTrue);
+    expect(graph.latency(), equals(128));
+
+    final out = <double>[];
+    var next = 0;
+    for (final n in [37, 200, 1, 64, 311, 99]) {
+      final inL = Float32List.fromList(List.generate(n, (i) => (next + i).toDouble()));
+      final outL = Float32List(n);
+      final outR = Float32List(n);
+      expect(graph.process(inL, inL, outL, outR), isTrue);
+      out.addAll(outL);
+      next += n;
+    }
+    for (var i = 0; i < out.length; i++) {
+      expect(out[i], equals(i < 128 ? 0.0 : (i - 128).toDouble()));
+    }
+    expect(graph.setBlockQuantum(0), isTrue);
+    expect(graph.latency(), equals(0));
+  });
+
+  test('double precision carries 64-bit samples between nodes', () {
+    final input = graph.addSplit();
+    final a = graph.addGain(0.0);
+    final b = graph.addGain(0.0);
+    final output = graph.addMixer(2);
+    expect(graph.connect(input, a), isTrue);
+    expect(graph.connect(input, b), isTrue);
+    expect(graph.connect(a, output, dstBus: 0), isTrue);
+    expect(graph.connect(b, output, dstBus: 1), isTrue);
+    expect(graph.setIO(inputNode: input, outputNode: output), isTrue);
+    expect(graph.setDoublePrecision(true), isTrue);
+
+    const n = 700;
+    final inL = Float64List.fromList(List.generate(n, (i) => 1.0 / (i + 3)));
+    final outL = Float64List(n);
+    final outR = Float64List(n);
+    expect(graph.processF64(inL, inL, outL, outR), isTrue);
+    for (var i = 0; i < n; i++) {
+      expect(outL[i], equals(2 * inL[i]));
+    }
+
+    // 32-bit callers are converted at the graph boundary.
+    final fIn = Float32List.fromList(inL);
+    final fOutL = Float32List(n);
+    final fOutR = Float32List(n);
+    expect(graph.process(fIn, fIn, fOutL, fOutR), isTrue);
+    expect(fOutR[n - 1], closeTo(2 * inL[n - 1], 1e-6));
+    expect(graph.setDoublePrecision(false), isTrue);
+  });
+
+  test('nodes sleep on silent input and wake on signal or events', () {
+    final input = graph.addSplit();
+    final gain = graph.addGain(0.0);
+    expect(graph.connect(input, gain), isTrue);
+    expect(graph.setIO(inputNode: input, outputNode: gain), isTrue);
+
+    final silence = Float32List(512);
+    final signal = Float32List(512)..fillRange(0, 512, 0.5);
+    final outL = Float32List(512);
+    final outR = Float32List(512);
+    expect(graph.process(signal, signal, outL, outR), isTrue);
+    expect(graph.isSleeping(gain), isFalse);
+    graph.process(silence, silence, outL, outR);
+    graph.process(silence, silence, outL, outR);
+    expect(graph.isSleeping(gain), isTrue);
+    expect(outL.every((v) => v == 0), isTrue);
+
+    // A parameter change due in the next block wakes the node.
+    expect(graph.setParam(gain, 0, 0.5, sampleOffset: 100), isTrue);
+    graph.process(silence, silence, outL, outR);
+    expect(graph.isSleeping(gain), isFalse);
+
+    graph.process(silence, silence, outL, outR);
+    expect(graph.isSleeping(gain), isTrue);
+    expect(graph.process(signal, signal, outL, outR), isTrue);
+    expect(graph.isSleeping(gain), isFalse);
+    expect(outL[0], closeTo(0.5 * 0.0316, 1e-3));
+  });
+
+  test('latent nodes stay awake until their delayed output is out', () {
+    final input = graph.addSplit();
+    final delay = graph.debugAddDelay(50);
+    expect(graph.connect(input, delay), isTrue);
+    expect(graph.setIO(inputNode: input, outputNode: delay), isTrue);
+    expect(graph.latency(), 50);
+
+    final impulse = Float32List(16)..[0] = 1.0;
+    final silence = Float32List(16);
+    final outL = Float32List(16);
+    final outR = Float32List(16);
+    final rendered = <double>[];
+    expect(graph.process(impulse, impulse, outL, outR), isTrue);
+    rendered.addAll(outL);
+    for (var block = 1; block < 8; block++) {
+      expect(graph.process(silence, silence, outL, outR), isTrue);
+      rendered.addAll(outL);
+    }
+    expect(rendered[50], 1.0);
+    expect(rendered.where((v) => v != 0).length, 1);
+    expect(graph.isSleeping(delay), isTrue);
+  });
+
+  test('compensation delays keep their audio across edits', () {
+    final input = graph.addSplit();
+    final delay = graph.debugAddDelay(50);
+    final output = graph.addSplit();
+    expect(graph.connect(input, delay), isTrue);
+    expect(graph.connect(delay, output), isTrue);
+    expect(graph.connect(input, output), isTrue); // compensated by 50
+    expect(graph.setIO(inputNode: input, outputNode: output), isTrue);
+
+    final inL = Float32List(32);
+    final outL = Float32List(32);
+    final outR = Float32List(32);
+    var t = 0;
+    for (var block = 0; block < 8; block++) {
+      if (block == 3) graph.addGain(0.0); // unrelated edit mid-stream
+      for (var i = 0; i < 32; i++) {
+        inL[i] = (t + i).toDouble();
+      }
+      expect(graph.process(inL, inL, outL, outR), isTrue);
+      for (var i = 0; i < 32; i++) {
+        final src = t + i - 50;
+        expect(outL[i], src < 0 ? 0.0 : 2.0 * src);
+      }
+      t += 32;
+    }
+  });
+
+  test('long chains reuse buffers and render into the output', () {
+    final input = graph.addSplit();
+    var prev = input;
+    for (var i = 0; i < 50; i++) {
+      final gain = graph.addGain(-0.1);
+      expect(graph.connect(prev, gain), isTrue);
+      prev = gain;
+    }
+    final output = graph.addSplit();
+    expect(graph.connect(prev, output), isTrue);
+    expect(graph.setIO(inputNode: input, outputNode: output), isTrue);
+    expect(graph.debugBufferCount(), lessThanOrEqualTo(2));
+
+    final inL = Float32List(512)..fillRange(0, 512, 1.0);
+    final outL = Float32List(512);
+    final outR = Float32List(512);
+    expect(graph.process(inL, inL, outL, outR), isTrue);
+    expect(outL[100], closeTo(0.5623, 1e-3)); // -5 dB
+    expect(outR[511], closeTo(0.5623, 1e-3));
+  });
+}
@@ -19,6 +19,7 @@ typedef _UnloadC = Void Function(Pointer<Void>);
 
 typedef _ResumeC = Int32 Function(Pointer<Void>, Double, Int32);
 typedef _SuspendC = Int32 Function(Pointer<Void>);
+typedef _LatencyC = Int32 Function(Pointer<Void>);
 
 typedef _ProcessStereoC = Int32 Function(
   Pointer<Void>,
@@ -26,12 +27,33 @@ typedef _ProcessStereoC = Int32 Function(
   Pointer<Float>, Pointer<Float>,
   Int32);
 
+typedef _ProcessC = Int32 Function(
+  Pointer<Void>,
+  Pointer<Pointer<Pointer<Float>>>, Int32,
+  Pointer<Pointer<Pointer<Float>>>, Int32,
+  Int32);
+typedef _SupportsDoubleC = Int32 Function(Pointer<Void>);
+typedef _SetDoubleC = Int32 Function(Pointer<Void>, Int32);
+typedef _BusCountC = Int32 Function(Pointer<Void>, Int32);
+typedef _BusChannelsC = Int32 Function(Pointer<Void>, Int32, Int32);
+typedef _SetBusArrangementC = Int32 Function(Pointer<Void>, Int32, Int32, Uint64);
+
 typedef _NoteC = Int32 Function(Pointer<Void>, Int32, Int32, Float);
+typedef _NoteAtC = Int32 Function(Pointer<Void>, Int32, Int32, Int32, Float);
 
 typedef _ParamCountC = Int32 Function(Pointer<Void>);
 typedef _ParamInfoC = Int32 Function(Pointer<Void>, Int32, Pointer<Int32>, Pointer<Utf8>, Int32, Pointer<Utf8>, Int32);
 typedef _GetParamC = Float Function(Pointer<Void>, Int32);
 typedef _SetParamC = Int32 Function(Pointer<Void>, Int32, Float);
+typedef _SetParamAtC = Int32 Function(Pointer<Void>, Int32, Int32, Float);
+typedef _DroppedEventsC = Int64 Function(Pointer<Void>);
+
+typedef _ScanC = Int32 Function(Pointer<Pointer<Utf8>>, Int32, Pointer<Utf8>, Int32);
+typedef _OpenIndexC = Pointer<Void> Function(Pointer<Utf8>);
+typedef _CloseIndexC = Void Function(Pointer<Void>);
+typedef _IndexCountC = Int32 Function(Pointer<Void>);
+typedef _IndexStringC = Pointer<Utf8> Function(Pointer<Void>, Int32, Int32);
+typedef _IndexIntC = Int32 Function(Pointer<Void>, Int32, Int32);
 
 /// Wrapper around the dynamic library providing access to the C
 /// functions. Users generally should not use this directly; instead
@@ -60,15 +82,42 @@ class NativeBindings {
   late final int Function(Pointer<Void>) dvhSuspend =
       lib.lookupFunction<_SuspendC, int Function(Pointer<Void>)>('dvh_suspend');
 
+  late final int Function(Pointer<Void>) dvhGetLatencySamples =
+      lib.lookupFunction<_LatencyC, int Function(Pointer<Void>)>('dvh_get_latency_samples');
+
   late final int Function(Pointer<Void>, Pointer<Float>, Pointer<Float>, Pointer<Float>, Pointer<Float>, int) dvhProcessStereoF32 =
       lib.lookupFunction<_ProcessStereoC, int Function(Pointer<Void>, Pointer<Float>, Pointer<Float>, Pointer<Float>, Pointer<Float>, int)>('dvh_process_stereo_f32');
 
+  late final int Function(Pointer<Void>, Pointer<Pointer<Pointer<Float>>>, int, Pointer<Pointer<Pointer<Float>>>, int, int) dvhProcessF32 =
+      lib.lookupFunction<_ProcessC, int Function(Pointer<Void>, Pointer<Pointer<Pointer<Float>>>, int, Pointer<Pointer<Pointer<Float>>>, int, int)>('dvh_process_f32');
+
+  late final int Function(Pointer<Void>) dvhSupportsDoublePrecision =
+      lib.lookupFunction<_SupportsDoubleC, int Function(Pointer<Void>)>('dvh_supports_double_precision');
+
+  late final int Function(Pointer<Void>, int) dvhSetDoublePrecision =
+      lib.lookupFunction<_SetDoubleC, int Function(Pointer<Void>, int)>('dvh_set_double_precision');
+
+  late final int Function(Pointer<Void>, int) dvhGetBusCount =
+      lib.lookupFunction<_BusCountC, int Function(Pointer<Void>, int)>('dvh_get_bus_count');
+
+  late final int Function(Pointer<Void>, int, int) dvhGetBusChannels =
+      lib.lookupFunction<_BusChannelsC, int Function(Pointer<Void>, int, int)>('dvh_get_bus_channels');
+
+  late final int Function(Pointer<Void>, int, int, int) dvhSetBusArrangement =
+      lib.lookupFunction<_SetBusArrangementC, int Function(Pointer<Void>, int, int, int)>('dvh_set_bus_arrangement');
+
   late final int Function(Pointer<Void>, int, int, double) dvhNoteOn =
       lib.lookupFunction<_NoteC, int Function(Pointer<Void>, int, int, double)>('dvh_note_on');
 
   late final int Function(Pointer<Void>, int, int, double) dvhNoteOff =
       lib.lookupFunction<_NoteC, int Function(Pointer<Void>, int, int, double)>('dvh_note_off');
 
+  late final int Function(Pointer<Void>, int, int, int, double) dvhNoteOnAt =
+      lib.lookupFunction<_NoteAtC, int Function(Pointer<Void>, int, int, int, double)>('dvh_note_on_at');
+
+  late final int Function(Pointer<Void>, int, int, int, double) dvhNoteOffAt =
+      lib.lookupFunction<_NoteAtC, int Function(Pointer<Void>, int, int, int, double)>('dvh_note_off_at');
+
   late final int Function(Pointer<Void>) dvhParamCount =
       lib.lookupFunction<_ParamCountC, int Function(Pointer<Void>)>('dvh_param_count');
 
@@ -80,6 +129,30 @@ class NativeBindings {
 
   late final int Function(Pointer<Void>, int, double) dvhSetParam =
       lib.lookupFunction<_SetParamC, int Function(Pointer<Void>, int, double)>('dvh_set_param_normalized');
+
+  late final int Function(Pointer<Void>, int, int, double) dvhSetParamAt =
+      lib.lookupFunction<_SetParamAtC, int Function(Pointer<Void>, int, int, double)>('dvh_set_param_at');
+
+  late final int Function(Pointer<Void>) dvhGetDroppedEventCount =
+      lib.lookupFunction<_DroppedEventsC, int Function(Pointer<Void>)>('dvh_get_dropped_event_count');
+
+  late final int Function(Pointer<Pointer<Utf8>>, int, Pointer<Utf8>, int) dvhScanPlugins =
+      lib.lookupFunction<_ScanC, int Function(Pointer<Pointer<Utf8>>, int, Pointer<Utf8>, int)>('dvh_scan_plugins');
+
+  late final Pointer<Void> Function(Pointer<Utf8>) dvhOpenScanIndex =
+      lib.lookupFunction<_OpenIndexC, Pointer<Void> Function(Pointer<Utf8>)>('dvh_open_scan_index');
+
+  late final void Function(Pointer<Void>) dvhCloseScanIndex =
+      lib.lookupFunction<_CloseIndexC, void Function(Pointer<Void>)>('dvh_close_scan_index');
+
+  late final int Function(Pointer<Void>) dvhScanIndexCount =
+      lib.lookupFunction<_IndexCountC, int Function(Pointer<Void>)>('dvh_scan_index_count');
+
+  late final Pointer<Utf8> Function(Pointer<Void>, int, int) dvhScanIndexString =
+      lib.lookupFunction<_IndexStringC, Pointer<Utf8> Function(Pointer<Void>, int, int)>('dvh_scan_index_string');
+
+  late final int Function(Pointer<Void>, int, int) dvhScanIndexInt =
+      lib.lookupFunction<_IndexIntC, int Function(Pointer<Void>, int, int)>('dvh_scan_index_int');
 }
 
 /// Load the native library. The optional [path] may be used to point
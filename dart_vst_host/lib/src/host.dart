@@ -159,6 +159,9 @@ class VstPlugin {
   /// Deactivate processing. Returns true on success.
   bool suspend() => _b.dvhSuspend(handle) == 1;
 
+  /// Processing latency reported by the plug‑in, in samples.
+  int latencySamples() => _b.dvhGetLatencySamples(handle);
+
   /// Release this plug‑in from the host. After calling unload() the
   /// handle is invalid. Further calls on this instance will throw.
   void unload() => _b.dvhUnloadPlugin(handle);
@@ -186,18 +189,94 @@ class VstPlugin {
   /// Get the normalized value of a parameter by ID.
   double getParamNormalized(int paramId) => _b.dvhGetParam(handle, paramId);
 
-  /// Set the normalized value of a parameter by ID. Returns true on
-  /// success.
-  bool setParamNormalized(int paramId, double value) =>
-      _b.dvhSetParam(handle, paramId, value) == 1;
+  /// Set the normalized value of a parameter by ID. The change takes
+  /// effect [sampleOffset] frames into the next processed block.
+  /// Returns true on success.
+  bool setParamNormalized(int paramId, double value, {int sampleOffset = 0}) =>
+      _b.dvhSetParamAt(handle, paramId, sampleOffset, value) == 1;
+
+  /// Send a MIDI note on event [sampleOffset] frames into the next
+  /// processed block. Channel is zero‑based.
+  bool noteOn(int channel, int note, double velocity, {int sampleOffset = 0}) =>
+      _b.dvhNoteOnAt(handle, sampleOffset, channel, note, velocity) == 1;
+
+  /// Send a MIDI note off event [sampleOffset] frames into the next
+  /// processed block.
+  bool noteOff(int channel, int note, double velocity, {int sampleOffset = 0}) =>
+      _b.dvhNoteOffAt(handle, sampleOffset, channel, note, velocity) == 1;
+
+  /// Number of notes and parameter changes dropped because the
+  /// plug‑in's event queue was full. Events may be sent from any
+  /// isolate or thread; they are queued without blocking the audio
+  /// thread and delivered on the next processed block.
+  int droppedEventCount() => _b.dvhGetDroppedEventCount(handle);
+
+  /// Whether the plug‑in can process 64‑bit samples.
+  bool supportsDoublePrecision() => _b.dvhSupportsDoublePrecision(handle) == 1;
+
+  /// Switch the plug‑in to 64‑bit (true) or 32‑bit (false) samples,
+  /// restarting it if active. The 32‑bit process calls fail while 64‑bit
+  /// processing is enabled. Returns false if the plug‑in cannot process
+  /// 64‑bit samples.
+  bool setDoublePrecision(bool enable) => _b.dvhSetDoublePrecision(handle, enable ? 1 : 0) == 1;
 
-  /// Send a MIDI note on event. Channel is zero‑based.
-  bool noteOn(int channel, int note, double velocity) =>
-      _b.dvhNoteOn(handle, channel, note, velocity) == 1;
+  /// Number of audio input or output buses the plug‑in declares.
+  int busCount({required bool input}) => _b.dvhGetBusCount(handle, input ? 1 : 0);
 
-  /// Send a MIDI note off event.
-  bool noteOff(int channel, int note, double velocity) =>
-      _b.dvhNoteOff(handle, channel, note, velocity) == 1;
+  /// Channels of audio bus [bus]. After [resume] this reflects the
+  /// arrangement negotiated with the plug‑in.
+  int busChannels(int bus, {required bool input}) => _b.dvhGetBusChannels(handle, input ? 1 : 0, bus);
+
+  /// Request a VST3 speaker arrangement bit mask for a bus, e.g. 0x3F
+  /// for 5.1. Takes effect on the next [resume] if the plug‑in accepts
+  /// it. Returns false if the bus does not exist.
+  bool setBusArrangement(int bus, int speakerArrangement, {required bool input}) =>
+      _b.dvhSetBusArrangement(handle, input ? 1 : 0, bus, speakerArrangement) == 1;
+
+  /// Process one block on all buses. [inputs] and [outputs] hold one
+  /// list of planar channels per bus, sized by [busChannels]. Missing
+  /// buses are fed silence or discarded. All channels must have the
+  /// same length. Returns true on success.
+  bool process(List<List<Float32List>> inputs, List<List<Float32List>> outputs) {
+    final channels = [...inputs, ...outputs].expand((bus) => bus);
+    final n = channels.firstOrNull?.length ?? 0;
+    for (final ch in channels) {
+      if (ch.length != n) throw ArgumentError('All channels must have same length');
+    }
+    final allocated = <Pointer>[];
+    Pointer<Pointer<Pointer<Float>>> buses(List<List<Float32List>> list, {required bool copy}) {
+      final arr = malloc<Pointer<Pointer<Float>>>(list.isEmpty ? 1 : list.length);
+      allocated.add(arr);
+      for (var b = 0; b < list.length; b++) {
+        final chans = malloc<Pointer<Float>>(list[b].isEmpty ? 1 : list[b].length);
+        allocated.add(chans);
+        for (var c = 0; c < list[b].length; c++) {
+          final buf = malloc<Float>(n == 0 ? 1 : n);
+          allocated.add(buf);
+          if (copy) buf.asTypedList(n).setAll(0, list[b][c]);
+          chans[c] = buf;
+        }
+        arr[b] = chans;
+      }
+      return arr;
+    }
+    try {
+      final pIn = buses(inputs, copy: true);
+      final pOut = buses(outputs, copy: false);
+      final ok = _b.dvhProcessF32(handle, pIn, inputs.length, pOut, outputs.length, n) == 1;
+      if (!ok) return false;
+      for (var b = 0; b < outputs.length; b++) {
+        for (var c = 0; c < outputs[b].length; c++) {
+          outputs[b][c].setAll(0, pOut[b][c].asTypedList(n));
+        }
+      }
+      return true;
+    } finally {
+      for (final p in allocated) {
+        malloc.free(p);
+      }
+    }
+  }
 
   /// Process a block of stereo audio. The input and output lists must
   /// all have the same length. Returns true on success.
@@ -225,4 +304,123 @@ class VstPlugin {
       malloc.free(pOutR);
     }
   }
-}
\ No newline at end of file
+}
+/// A class exported by a scanned VST3 bundle. Pass [path] and [uid]
+/// to [VstHost.load] to instantiate it. Bus, channel and parameter
+/// counts are only recorded for audio modules and are 0 otherwise.
+class PluginDescription {
+  final String path;
+  final String uid;
+  final String name;
+  final String vendor;
+  final String version;
+  final String category;
+  final String subCategories;
+  final int audioInputBuses;
+  final int audioOutputBuses;
+  final int mainInputChannels;
+  final int mainOutputChannels;
+  final int eventInputBuses;
+  final int paramCount;
+
+  PluginDescription({
+    required this.path,
+    required this.uid,
+    required this.name,
+    required this.vendor,
+    required this.version,
+    required this.category,
+    required this.subCategories,
+    required this.audioInputBuses,
+    required this.audioOutputBuses,
+    required this.mainInputChannels,
+    required this.mainOutputChannels,
+    required this.eventInputBuses,
+    required this.paramCount,
+  });
+
+  /// Whether this class is an audio processor that can be loaded.
+  bool get isAudioModule => category == 'Audio Module Class';
+
+  /// Whether the plug‑in accepts notes, i.e. is likely an instrument.
+  bool get acceptsEvents => eventInputBuses > 0;
+}
+
+/// An on‑disk index of installed plug‑ins written by [scan]. Opening
+/// an index memory maps it without loading any plug‑in, so it can be
+/// browsed at startup. Must be closed when no longer needed.
+class VstPluginIndex {
+  final NativeBindings _b;
+  final Pointer<Void> handle;
+  VstPluginIndex._(this._b, this.handle);
+
+  /// Scan [directories] (or the platform's standard VST3 locations if
+  /// null or empty) and write the index to [indexPath]. Only bundles
+  /// added or modified since the last scan into the same index are
+  /// loaded, on up to [threads] threads (0 uses one per core). Returns
+  /// the number of bundles loaded; throws StateError if the index
+  /// cannot be written.
+  static int scan({required String indexPath, List<String>? directories, int threads = 0, String? dylibPath}) {
+    final b = NativeBindings(loadDvh(path: dylibPath));
+    final dirs = directories ?? const <String>[];
+    final arr = malloc<Pointer<Utf8>>(dirs.isEmpty ? 1 : dirs.length);
+    final idx = indexPath.toNativeUtf8();
+    for (var i = 0; i < dirs.length; i++) {
+      arr[i] = dirs[i].toNativeUtf8();
+    }
+    try {
+      final n = b.dvhScanPlugins(arr, dirs.length, idx, threads);
+      if (n < 0) throw StateError('Failed to write plug‑in index $indexPath');
+      return n;
+    } finally {
+      for (var i = 0; i < dirs.length; i++) {
+        malloc.free(arr[i]);
+      }
+      malloc.free(arr);
+      malloc.free(idx);
+    }
+  }
+
+  /// Open an index written by [scan]. Returns null if it does not
+  /// exist or was written by an incompatible version.
+  static VstPluginIndex? open(String indexPath, {String? dylibPath}) {
+    final b = NativeBindings(loadDvh(path: dylibPath));
+    final p = indexPath.toNativeUtf8();
+    final h = b.dvhOpenScanIndex(p);
+    malloc.free(p);
+    return h == nullptr ? null : VstPluginIndex._(b, h);
+  }
+
+  /// Number of classes in the index.
+  int get length => _b.dvhScanIndexCount(handle);
+
+  /// Description of the class at [index].
+  PluginDescription operator [](int index) {
+    if (index < 0 || index >= length) throw RangeError.index(index, this);
+    String str(int field) => _b.dvhScanIndexString(handle, index, field).toDartString();
+    int num(int field) => _b.dvhScanIndexInt(handle, index, field);
+    return PluginDescription(
+      path: str(0),
+      uid: str(1),
+      name: str(2),
+      vendor: str(3),
+      version: str(4),
+      category: str(5),
+      subCategories: str(6),
+      audioInputBuses: num(0),
+      audioOutputBuses: num(1),
+      mainInputChannels: num(2),
+      mainOutputChannels: num(3),
+      eventInputBuses: num(4),
+      paramCount: num(5),
+    );
+  }
+
+  /// All audio processors in the index.
+  List<PluginDescription> get plugins => [
+        for (var i = 0; i < length; i++) this[i],
+      ].where((d) => d.isAudioModule).toList();
+
+  /// Unmap the index. Descriptions already read remain valid.
+  void close() => _b.dvhCloseScanIndex(handle);
+}
@@ -20,6 +20,7 @@ extern "C" {
 
 typedef void* DVH_Host;
 typedef void* DVH_Plugin;
+typedef void* DVH_ScanIndex;
 
 // Create a VST3 host. Provide sample rate and max block size.
 DVH_API DVH_Host dvh_create_host(double sample_rate, int32_t max_block);
@@ -32,20 +33,93 @@ DVH_API DVH_Plugin dvh_load_plugin(DVH_Host host, const char* module_path_utf8,
 DVH_API void       dvh_unload_plugin(DVH_Plugin p);
 
 // Resume processing on a plugin. Must be called after loading before processing.
+// Negotiates bus arrangements (main buses default to stereo) and activates all
+// audio and event input buses.
 DVH_API int32_t dvh_resume(DVH_Plugin p, double sample_rate, int32_t max_block);
 // Suspend processing on a plugin.
 DVH_API int32_t dvh_suspend(DVH_Plugin p);
 
-// Process stereo audio. Input pointers must be valid arrays of length num_frames. Output will be written in-place.
+// Process stereo audio. Input pointers must be valid arrays of length num_frames, or null for silence (num_frames
+// must then not exceed the max_block passed to dvh_resume). Output will be written in-place. Uses the main
+// buses only; other buses get silence. Fails if the plugin is not resumed.
 DVH_API int32_t dvh_process_stereo_f32(DVH_Plugin p,
                                        const float* inL, const float* inR,
                                        float* outL, float* outR,
                                        int32_t num_frames);
 
+// Process audio on all buses. inputs[b][c] is channel c of input bus b, likewise
+// for outputs; each bus array must hold dvh_get_bus_channels() pointers. Buses
+// past num_input_buses/num_output_buses and null bus or channel pointers read
+// silence or have their output discarded (num_frames must then not exceed
+// max_block). No allocation happens per call.
+DVH_API int32_t dvh_process_f32(DVH_Plugin p,
+                                const float* const* const* inputs, int32_t num_input_buses,
+                                float* const* const* outputs, int32_t num_output_buses,
+                                int32_t num_frames);
+
+// 64-bit variants. Only valid after dvh_set_double_precision(p, 1); likewise the
+// 32-bit calls fail while the plugin processes doubles.
+DVH_API int32_t dvh_process_f64(DVH_Plugin p,
+                                const double* const* const* inputs, int32_t num_input_buses,
+                                double* const* const* outputs, int32_t num_output_buses,
+                                int32_t num_frames);
+DVH_API int32_t dvh_process_stereo_f64(DVH_Plugin p,
+                                       const double* inL, const double* inR,
+                                       double* outL, double* outR,
+                                       int32_t num_frames);
+
+// Whether the plugin can process 64-bit samples.
+DVH_API int32_t dvh_supports_double_precision(DVH_Plugin p);
+// Select 64-bit (non-zero) or 32-bit (0) samples. Returns 0 if the plugin cannot
+// process doubles. Takes effect immediately, restarting an active plugin; must
+// not be called while the plugin is being processed.
+DVH_API int32_t dvh_set_double_precision(DVH_Plugin p, int32_t enable);
+
+// Number of audio buses the plugin declares.
+DVH_API int32_t dvh_get_bus_count(DVH_Plugin p, int32_t is_input);
+// Channels of an audio bus. After dvh_resume() this is the negotiated layout.
+DVH_API int32_t dvh_get_bus_channels(DVH_Plugin p, int32_t is_input, int32_t bus);
+// Silence flags of an audio bus for the last processed block: bit c is set when
+// channel c is silent. Input channels are flagged when they were fed silence (a
+// null channel pointer); output flags are whatever the plugin reported.
+// Returns 0 if the bus does not exist or the plugin is not active.
+DVH_API int32_t dvh_get_silence_flags(DVH_Plugin p, int32_t is_input, int32_t bus, uint64_t* flags);
+// Request a VST3 speaker arrangement bit mask (e.g. 0x1 mono, 0x3 stereo,
+// 0x3F 5.1) for an audio bus. Applied by the next dvh_resume(); the plugin may
+// refuse, in which case its own arrangement is used.
+DVH_API int32_t dvh_set_bus_arrangement(DVH_Plugin p, int32_t is_input, int32_t bus, uint64_t speaker_arrangement);
+
+// Select offline (non-zero) or real-time (0) processing. Offline lets plugins
+// use their highest quality algorithms since processing need not keep up with
+// real time. Must not be called while the plugin is being processed.
+DVH_API int32_t dvh_set_offline(DVH_Plugin p, int32_t offline);
+
+// Processing latency reported by the plugin in samples. Query again after
+// dvh_resume() since plugins may change their latency on setup. Returns 0 if
+// the plugin reports none.
+DVH_API int32_t dvh_get_latency_samples(DVH_Plugin p);
+
+// Number of samples the plugin keeps producing output after its input falls
+// silent (reverb or delay tails), or -1 if the tail is infinite (e.g. a
+// generator). Like the latency it may change on dvh_resume().
+DVH_API int32_t dvh_get_tail_samples(DVH_Plugin p);
+
 // Send a NoteOn to the plugin. Channel and pitch follow MIDI convention. Velocity in [0,1].
 DVH_API int32_t dvh_note_on(DVH_Plugin p, int32_t channel, int32_t note, float velocity);
 // Send a NoteOff to the plugin.
 DVH_API int32_t dvh_note_off(DVH_Plugin p, int32_t channel, int32_t note, float velocity);
+// Sample accurate variants. sample_offset is relative to the start of the next
+// processed block. Events at or past that block's num_frames are held back and
+// delivered in the block they fall in. Events are delivered to the plugin
+// sorted by offset.
+//
+// Notes and parameter changes may be sent from any thread. They are queued in a
+// bounded lock-free ring per plugin that the audio thread drains at the start of
+// each process call, so senders never block processing. When the ring is full
+// the event is dropped, the call returns 0 and dvh_get_dropped_event_count()
+// is incremented.
+DVH_API int32_t dvh_note_on_at(DVH_Plugin p, int32_t sample_offset, int32_t channel, int32_t note, float velocity);
+DVH_API int32_t dvh_note_off_at(DVH_Plugin p, int32_t sample_offset, int32_t channel, int32_t note, float velocity);
 
 // Query number of parameters for a plugin. Returns 0 if no controller present.
 DVH_API int32_t dvh_param_count(DVH_Plugin p);
@@ -59,6 +133,60 @@ DVH_API int32_t dvh_param_info(DVH_Plugin p, int32_t index,
 DVH_API float   dvh_get_param_normalized(DVH_Plugin p, int32_t param_id);
 // Set a parameter normalized value. Returns 1 on success.
 DVH_API int32_t dvh_set_param_normalized(DVH_Plugin p, int32_t param_id, float normalized);
+// Set a parameter at a sample offset within the next processed block. Several
+// points per parameter and block are passed on as one automation curve.
+DVH_API int32_t dvh_set_param_at(DVH_Plugin p, int32_t param_id, int32_t sample_offset, float normalized);
+
+// Number of note and parameter events dropped because the plugin's event queue
+// was full.
+DVH_API int64_t dvh_get_dropped_event_count(DVH_Plugin p);
+
+// Plugin scanning. dvh_scan_plugins() walks the given directories (or the
+// platform's standard VST3 locations when num_dirs is 0) for .vst3 bundles
+// and writes an index of every class they export to index_path_utf8. Bundles
+// are keyed by canonical path and modification time: records of unchanged
+// bundles are copied from the existing index, and only new or modified
+// bundles are loaded. Bundles that fail to load are remembered and retried
+// only once they change. Loading runs on up to num_threads threads (0 uses
+// one per core, 1 scans on the calling thread). Returns the number of bundles
+// loaded, or -1 if the index could not be written. The index is replaced
+// atomically; on Windows it must not be open while rescanning.
+DVH_API int32_t dvh_scan_plugins(const char* const* dirs_utf8, int32_t num_dirs,
+                                 const char* index_path_utf8, int32_t num_threads);
+
+// Open an index written by dvh_scan_plugins(). The file is memory mapped and
+// no plugin is loaded. Returns null if the file is missing or not a valid
+// index of this version.
+DVH_API DVH_ScanIndex dvh_open_scan_index(const char* index_path_utf8);
+DVH_API void          dvh_close_scan_index(DVH_ScanIndex index);
+
+// Fields of a scanned class.
+enum {
+  DVH_SCAN_PATH = 0,          // bundle path, pass to dvh_load_plugin()
+  DVH_SCAN_UID,               // class UID, pass to dvh_load_plugin()
+  DVH_SCAN_NAME,
+  DVH_SCAN_VENDOR,
+  DVH_SCAN_VERSION,
+  DVH_SCAN_CATEGORY,          // "Audio Module Class" for processors
+  DVH_SCAN_SUBCATEGORIES      // e.g. "Fx|Reverb"
+};
+enum {
+  DVH_SCAN_AUDIO_INPUT_BUSES = 0,
+  DVH_SCAN_AUDIO_OUTPUT_BUSES,
+  DVH_SCAN_MAIN_INPUT_CHANNELS,
+  DVH_SCAN_MAIN_OUTPUT_CHANNELS,
+  DVH_SCAN_EVENT_INPUT_BUSES,
+  DVH_SCAN_PARAM_COUNT
+};
+
+// Number of classes in an index.
+DVH_API int32_t     dvh_scan_index_count(DVH_ScanIndex index);
+// String field of a class. The pointer stays valid until the index is closed.
+// Returns null if entry or field is out of range.
+DVH_API const char* dvh_scan_index_string(DVH_ScanIndex index, int32_t entry, int32_t field);
+// Integer field of a class. Bus, channel and parameter counts are only
+// recorded for audio module classes and are 0 for others.
+DVH_API int32_t     dvh_scan_index_int(DVH_ScanIndex index, int32_t entry, int32_t field);
 
 #ifdef __cplusplus
 }
@@ -9,10 +9,15 @@
 
 #include "dart_vst_host.h"
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
 #include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <filesystem>
 
 #include "pluginterfaces/base/ipluginbase.h"
 #include "pluginterfaces/base/funknown.h"
@@ -33,24 +38,159 @@
 #include "public.sdk/source/vst/hosting/eventlist.h"
 #include "public.sdk/source/vst/utility/stringconvert.h"
 
+#include "dvh_modules.h"
+
 using namespace Steinberg;
 using namespace Steinberg::Vst;
 
-// Host state object storing global context for a set of plugins. It
-// owns a HostApplication which can be queried by loaded plug‑ins.
+// PluginContextFactory holds a single process‑wide context, so every
+// host shares one HostApplication. It is created with the first host,
+// published to the factory once and released with the last host.
+static std::mutex g_contextMtx;
+static std::weak_ptr<HostApplication> g_context;
+
+std::shared_ptr<HostApplication> dvhAcquireHostContext() {
+  std::lock_guard<std::mutex> g(g_contextMtx);
+  if (auto ctx = g_context.lock()) return ctx;
+  std::shared_ptr<HostApplication> ctx(new HostApplication(), [](HostApplication* app) {
+    std::lock_guard<std::mutex> g(g_contextMtx);
+    auto& factory = Vst::PluginContextFactory::instance();
+    if (factory.getPluginContext() == app) factory.setPluginContext(nullptr);
+    delete app;
+  });
+  Vst::PluginContextFactory::instance().setPluginContext(ctx.get());
+  g_context = ctx;
+  return ctx;
+}
+
+// Host state object storing settings for a set of plugins. The
+// HostApplication queried by plug‑ins is shared between all hosts.
 struct DVH_HostState {
   double sr;
   int32 maxBlock;
-  HostApplication hostApp;
-  DVH_HostState(double s, int32 m) : sr(s), maxBlock(m) {
-    Vst::PluginContextFactory::instance().setPluginContext(&hostApp);
+  std::shared_ptr<HostApplication> context;
+  DVH_HostState(double s, int32 m) : sr(s), maxBlock(m), context(dvhAcquireHostContext()) {}
+};
+
+const VST3::Hosting::ClassInfo* DVH_ModuleEntry::find(const char* uid) const {
+  if (uid && *uid) {
+    auto it = byUid.find(uid);
+    return it == byUid.end() ? nullptr : &classes[it->second];
+  }
+  return firstAudioModule < 0 ? nullptr : &classes[firstAudioModule];
+}
+
+std::string dvhCanonicalPath(const char* pathUtf8) {
+  std::error_code ec;
+  auto canonical = std::filesystem::weakly_canonical(std::filesystem::u8path(pathUtf8), ec);
+  return ec ? std::string(pathUtf8) : canonical.u8string();
+}
+
+// Process‑wide module cache keyed by canonical path. Holds weak
+// references only, so it never keeps a library loaded by itself.
+static std::mutex g_modulesMtx;
+static std::unordered_map<std::string, std::weak_ptr<DVH_ModuleEntry>> g_modules;
+
+std::shared_ptr<DVH_ModuleEntry> dvhAcquireModule(const char* pathUtf8) {
+  const std::string key = dvhCanonicalPath(pathUtf8);
+  {
+    std::lock_guard<std::mutex> g(g_modulesMtx);
+    auto it = g_modules.find(key);
+    if (it != g_modules.end()) {
+      if (auto entry = it->second.lock()) return entry;
+    }
+  }
+
+  // Load without holding the cache lock so that different modules can
+  // be loaded in parallel by the scanner.
+  std::string err;
+  auto mod = VST3::Hosting::Module::create(key, err);
+  if (!mod) return nullptr;
+  auto entry = std::make_shared<DVH_ModuleEntry>();
+  entry->module = mod;
+  entry->classes = mod->getFactory().classInfos();
+  for (size_t i = 0; i < entry->classes.size(); ++i) {
+    const auto& ci = entry->classes[i];
+    entry->byUid.emplace(ci.ID().toString(), i);
+    if (entry->firstAudioModule < 0 && ci.category() == std::string(kVstAudioEffectClass))
+      entry->firstAudioModule = (int32)i;
+  }
+
+  std::lock_guard<std::mutex> g(g_modulesMtx);
+  auto& slot = g_modules[key];
+  if (auto winner = slot.lock()) return winner; // loaded concurrently by another thread
+  slot = entry;
+  // Drop entries whose modules have been unloaded.
+  for (auto e = g_modules.begin(); e != g_modules.end();)
+    e = e->second.expired() ? g_modules.erase(e) : std::next(e);
+  return entry;
+}
+
+// Note or parameter change queued for a plug‑in by any thread and
+// handed to the processor on the next process() call.
+struct DVH_QueuedEvent {
+  enum Kind : int32 { kNoteOn, kNoteOff, kParam };
+  Kind kind;
+  int32 sampleOffset;
+  int32 channelOrParam; // MIDI channel, or parameter ID for kParam
+  int32 note;
+  float value;          // velocity, or normalized value for kParam
+};
+
+// Bounded lock‑free multi‑producer, single‑consumer ring (Vyukov's
+// bounded queue). Producers claim a cell with one CAS and never wait
+// for the consumer; when the ring is full the event is dropped and
+// counted. The audio thread is the only consumer.
+struct DVH_EventRing {
+  static constexpr uint32_t kCapacity = 1024; // power of two
+  struct Cell {
+    std::atomic<uint32_t> seq;
+    DVH_QueuedEvent ev;
+  };
+  Cell cells[kCapacity];
+  alignas(64) std::atomic<uint32_t> head{0};
+  alignas(64) std::atomic<uint32_t> tail{0};
+  std::atomic<int64_t> dropped{0};
+
+  DVH_EventRing() {
+    for (uint32_t i = 0; i < kCapacity; ++i) cells[i].seq.store(i, std::memory_order_relaxed);
+  }
+  bool push(const DVH_QueuedEvent& e) {
+    uint32_t pos = head.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell& c = cells[pos & (kCapacity - 1)];
+      const int32_t dif = (int32_t)(c.seq.load(std::memory_order_acquire) - pos);
+      if (dif == 0) {
+        if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          c.ev = e;
+          c.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (dif < 0) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        pos = head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+  bool pop(DVH_QueuedEvent& e) {
+    const uint32_t pos = tail.load(std::memory_order_relaxed);
+    Cell& c = cells[pos & (kCapacity - 1)];
+    if ((int32_t)(c.seq.load(std::memory_order_acquire) - (pos + 1)) < 0) return false;
+    e = c.ev;
+    c.seq.store(pos + kCapacity, std::memory_order_release);
+    tail.store(pos + 1, std::memory_order_relaxed);
+    return true;
   }
 };
 
 // Per‑plugin state storing loaded module, component and controller
 // interfaces along with parameter change queues and event lists.
+// Notes and parameter changes from other threads go through the
+// event ring; the VST3 lists are only touched on the audio thread.
 struct DVH_PluginState {
-  std::shared_ptr<VST3::Hosting::Module> module;
+  std::shared_ptr<DVH_ModuleEntry> module; // declared first so it is released last
   VST3::Hosting::ClassInfo classInfo;
   IPtr<IComponent> component;
   IPtr<IAudioProcessor> processor;
@@ -61,8 +201,38 @@ struct DVH_PluginState {
   ParameterChanges inputParamChanges;
   ParameterChanges outputParamChanges;
   EventList inputEvents;
+  DVH_EventRing pending;
+  // Events scheduled past the end of the block being processed. Kept
+  // by the audio thread, with offsets relative to the next block.
+  static constexpr int32 kMaxDeferred = 256;
+  DVH_QueuedEvent deferred[kMaxDeferred];
+  int32 numDeferred{0};
 
   ProcessSetup setup{};
+  // max_block zero samples fed to unconnected inputs. Held as doubles
+  // so the same memory serves 32‑ and 64‑bit processing.
+  std::vector<double> silence;
+  int32 processMode{kRealtime};
+  int32 sampleSize{kSample32};
+
+  // Arrangements requested with dvh_set_bus_arrangement(), applied on
+  // the next dvh_resume(). kDefaultArrangement leaves the choice to
+  // negotiation.
+  static constexpr SpeakerArrangement kDefaultArrangement = ~SpeakerArrangement(0);
+  std::vector<SpeakerArrangement> requestedIn;
+  std::vector<SpeakerArrangement> requestedOut;
+  // Bus buffers and process data built in dvh_resume() from the
+  // negotiated layout and reused by every process call. Channel
+  // pointers of all buses live in one array per direction, typed by
+  // the sample size in use.
+  std::vector<AudioBusBuffers> inBuses;
+  std::vector<AudioBusBuffers> outBuses;
+  std::vector<void*> inChannels;
+  std::vector<void*> outChannels;
+  std::vector<double> scratch; // max_block samples per output channel nobody reads
+  std::vector<const void*> stereoIn; // main bus views for dvh_process_stereo_*
+  std::vector<void*> stereoOut;
+  ProcessData data{};
   bool active{false};
 
   std::mutex mtx;
@@ -80,15 +250,16 @@ static int32_t toOK(tresult r) { return r == kResultTrue ? 1 : 0; }
 extern "C" {
 
 // Create a new host state with the given sample rate and maximum
-// block size. This sets up the VST context factory to point at
-// HostApplication for plug‑ins to query host information.
+// block size. The first host sets up the VST context factory to point
+// at a HostApplication shared by all hosts in the process.
 DVH_Host dvh_create_host(double sample_rate, int32_t max_block) {
   auto* h = new DVH_HostState(sample_rate, max_block);
   return (DVH_Host)h;
 }
 
-// Destroy a previously created host. Frees all resources. Plug‑ins
-// loaded with this host must be destroyed before destroying the host.
+// Destroy a previously created host. The shared HostApplication is
+// released with the last host. Plug‑ins loaded with this host must be
+// destroyed before destroying the host.
 void dvh_destroy_host(DVH_Host host) {
   if (!host) return;
   delete (DVH_HostState*)host;
@@ -96,41 +267,25 @@ void dvh_destroy_host(DVH_Host host) {
 
 // Load a VST3 plug‑in from a module path. Optionally specify a class
 // UID string; if null or empty the first Audio Module Class is used.
-// On success a new DVH_PluginState is allocated and returned. On
-// failure returns nullptr.
+// Modules are cached per canonical path, so loading another instance
+// of an already loaded plug‑in only creates its component. On success
+// a new DVH_PluginState is allocated and returned. On failure returns
+// nullptr.
 DVH_Plugin dvh_load_plugin(DVH_Host host, const char* module_path_utf8, const char* class_uid_or_null) {
   if (!host || !module_path_utf8) return nullptr;
   auto* hs = (DVH_HostState*)host;
 
-  std::string err;
-  auto mod = VST3::Hosting::Module::create(module_path_utf8, err);
-  if (!mod) return nullptr;
-
-  VST3::Hosting::ClassInfo chosen;
-  bool found = false;
-  for (auto& ci : mod->getFactory().classInfos()) {
-    if (class_uid_or_null && *class_uid_or_null) {
-      if (ci.ID().toString() == std::string(class_uid_or_null)) {
-        chosen = ci;
-        found = true;
-        break;
-      }
-    } else {
-      if (ci.category() == std::string("Audio Module Class")) {
-        chosen = ci;
-        found = true;
-        break;
-      }
-    }
-  }
-  if (!found) return nullptr;
+  auto entry = dvhAcquireModule(module_path_utf8);
+  if (!entry) return nullptr;
+  const VST3::Hosting::ClassInfo* chosen = entry->find(class_uid_or_null);
+  if (!chosen) return nullptr;
 
-  auto plugProvider = std::make_shared<Vst::PlugProvider>(mod->getFactory(), chosen, true);
+  auto plugProvider = std::make_shared<Vst::PlugProvider>(entry->module->getFactory(), *chosen, true);
   if (!plugProvider->initialize()) return nullptr;
 
   auto* ps = new DVH_PluginState();
-  ps->module = mod;
-  ps->classInfo = chosen;
+  ps->module = entry;
+  ps->classInfo = *chosen;
   ps->component = plugProvider->getComponentPtr();
   ps->controller = plugProvider->getControllerPtr();
 
@@ -144,9 +299,9 @@ DVH_Plugin dvh_load_plugin(DVH_Host host, const char* module_path_utf8, const ch
     return nullptr;
   }
 
-  ps->component->initialize(&((DVH_HostState*)host)->hostApp);
+  ps->component->initialize(hs->context.get());
   if (ps->controller)
-    ps->controller->initialize(&((DVH_HostState*)host)->hostApp);
+    ps->controller->initialize(hs->context.get());
 
   // Connect component and controller via IConnectionPoint if both
   // expose it. This is necessary for parameter automation to flow.
@@ -162,8 +317,8 @@ DVH_Plugin dvh_load_plugin(DVH_Host host, const char* module_path_utf8, const ch
 }
 
 // Unload a previously loaded plug‑in. Terminates the component and
-// controller and frees the DVH_PluginState. Does nothing if p is
-// nullptr.
+// controller and frees the DVH_PluginState. The module is unloaded
+// once no other instance uses it. Does nothing if p is nullptr.
 void dvh_unload_plugin(DVH_Plugin p) {
   if (!p) return;
   auto* ps = (DVH_PluginState*)p;
@@ -180,25 +335,82 @@ void dvh_unload_plugin(DVH_Plugin p) {
   delete ps;
 }
 
-// Activate processing for a plug‑in. Sets up bus arrangements for
-// stereo input/output, configures the process setup and sets the
-// component active. Returns 1 on success.
+// Negotiate bus arrangements. Main buses are proposed as stereo
+// unless the caller asked for something else, other buses keep the
+// plug‑in's own arrangement. If the plug‑in rejects the proposal its
+// own arrangements are used, as VST3 prescribes. Every audio bus and
+// event input bus is activated.
+static void negotiateBuses(DVH_PluginState* ps) {
+  const int32 numIn = ps->component->getBusCount(kAudio, kInput);
+  const int32 numOut = ps->component->getBusCount(kAudio, kOutput);
+  auto propose = [&](BusDirection dir, int32 n, const std::vector<SpeakerArrangement>& requested) {
+    std::vector<SpeakerArrangement> arr(n, SpeakerArr::kStereo);
+    for (int32 i = 0; i < n; ++i) {
+      ps->processor->getBusArrangement(dir, i, arr[i]);
+      if (i < (int32)requested.size() && requested[i] != DVH_PluginState::kDefaultArrangement)
+        arr[i] = requested[i];
+      else if (i == 0)
+        arr[i] = SpeakerArr::kStereo;
+    }
+    return arr;
+  };
+  auto in = propose(kInput, numIn, ps->requestedIn);
+  auto out = propose(kOutput, numOut, ps->requestedOut);
+  ps->processor->setBusArrangements(in.data(), numIn, out.data(), numOut);
+
+  for (int32 i = 0; i < numIn; ++i) ps->component->activateBus(kAudio, kInput, i, true);
+  for (int32 i = 0; i < numOut; ++i) ps->component->activateBus(kAudio, kOutput, i, true);
+  const int32 numEvents = ps->component->getBusCount(kEvent, kInput);
+  for (int32 i = 0; i < numEvents; ++i) ps->component->activateBus(kEvent, kInput, i, true);
+}
+
+// Size the cached bus buffers to the arrangements the plug‑in ended
+// up with and point the cached ProcessData at them.
+static void buildBuses(DVH_PluginState* ps, int32 maxBlock) {
+  auto build = [&](BusDirection dir, std::vector<AudioBusBuffers>& buses, std::vector<void*>& channels) {
+    const int32 n = ps->component->getBusCount(kAudio, dir);
+    buses.assign(n, AudioBusBuffers{});
+    size_t total = 0;
+    for (int32 i = 0; i < n; ++i) {
+      SpeakerArrangement arr = SpeakerArr::kEmpty;
+      ps->processor->getBusArrangement(dir, i, arr);
+      buses[i].numChannels = SpeakerArr::getChannelCount(arr);
+      total += buses[i].numChannels;
+    }
+    channels.assign(total, nullptr);
+  };
+  build(kInput, ps->inBuses, ps->inChannels);
+  build(kOutput, ps->outBuses, ps->outChannels);
+  ps->scratch.assign(ps->outChannels.size() * maxBlock, 0.0);
+  ps->stereoIn.assign(std::max<int32>(2, ps->inBuses.empty() ? 0 : ps->inBuses[0].numChannels), nullptr);
+  ps->stereoOut.assign(std::max<int32>(2, ps->outBuses.empty() ? 0 : ps->outBuses[0].numChannels), nullptr);
+
+  ps->data = ProcessData{};
+  ps->data.numInputs = (int32)ps->inBuses.size();
+  ps->data.inputs = ps->inBuses.empty() ? nullptr : ps->inBuses.data();
+  ps->data.numOutputs = (int32)ps->outBuses.size();
+  ps->data.outputs = ps->outBuses.empty() ? nullptr : ps->outBuses.data();
+  ps->data.inputParameterChanges = &ps->inputParamChanges;
+  ps->data.outputParameterChanges = &ps->outputParamChanges;
+  ps->data.inputEvents = &ps->inputEvents;
+}
+
+// Activate processing for a plug‑in. Negotiates bus arrangements,
+// configures the process setup and sets the component active.
+// Returns 1 on success.
 int32_t dvh_resume(DVH_Plugin p, double sample_rate, int32_t max_block) {
   if (!p) return 0;
   auto* ps = (DVH_PluginState*)p;
   std::lock_guard<std::mutex> g(ps->mtx);
 
-  SpeakerArrangement inArr = SpeakerArr::kStereo;
-  SpeakerArrangement outArr = SpeakerArr::kStereo;
-  if (ps->processor->setBusArrangements(&inArr, 1, &outArr, 1) != kResultTrue) return 0;
+  negotiateBuses(ps);
+  buildBuses(ps, max_block);
 
-  ps->component->activateBus(kAudio, kInput, 0, true);
-  ps->component->activateBus(kAudio, kOutput, 0, true);
-
-  ps->setup.processMode = kRealtime;
-  ps->setup.symbolicSampleSize = kSample32;
+  ps->setup.processMode = ps->processMode;
+  ps->setup.symbolicSampleSize = ps->sampleSize;
   ps->setup.maxSamplesPerBlock = max_block;
   ps->setup.sampleRate = sample_rate;
+  ps->silence.assign(max_block, 0.0);
 
   if (ps->processor->setupProcessing(ps->setup) != kResultTrue) return 0;
   if (ps->component->setActive(true) != kResultTrue) return 0;
@@ -221,41 +433,209 @@ int32_t dvh_suspend(DVH_Plugin p) {
   return 1;
 }
 
-// Process a block of stereo audio. Copies input buffers into the
-// plug‑in’s buffers, calls process(), then copies the output back
-// out. Parameter changes and MIDI events are consumed each block.
-int32_t dvh_process_stereo_f32(DVH_Plugin p,
-                               const float* inL, const float* inR,
-                               float* outL, float* outR,
-                               int32_t num_frames) {
-  if (!p || !inL || !inR || !outL || !outR || num_frames <= 0) return 0;
+// Apply a changed ProcessSetup to an active plug‑in by stopping it,
+// setting it up again and restarting it. Must be called with ps->mtx
+// held. Returns 1 on success or if the plug‑in is not active.
+static int32_t restartProcessing(DVH_PluginState* ps) {
+  if (!ps->active) return 1;
+  ps->processor->setProcessing(false);
+  ps->component->setActive(false);
+  ps->active = false;
+  if (ps->processor->setupProcessing(ps->setup) != kResultTrue) return 0;
+  if (ps->component->setActive(true) != kResultTrue) return 0;
+  if (ps->processor->setProcessing(true) != kResultTrue) return 0;
+  ps->active = true;
+  return 1;
+}
+
+// Switch between real‑time and offline processing. VST3 only applies
+// a new process mode in setupProcessing(), so an active plug‑in is
+// stopped, set up again and restarted. Returns 1 on success.
+int32_t dvh_set_offline(DVH_Plugin p, int32_t offline) {
+  if (!p) return 0;
   auto* ps = (DVH_PluginState*)p;
   std::lock_guard<std::mutex> g(ps->mtx);
+  const int32 mode = offline ? kOffline : kRealtime;
+  if (ps->processMode == mode) return 1;
+  ps->processMode = mode;
+  ps->setup.processMode = mode;
+  return restartProcessing(ps);
+}
+
+// Switch between 32‑bit (0) and 64‑bit (non‑zero) samples. Returns 0
+// if the plug‑in cannot process doubles. Like the process mode, the
+// sample size only changes in setupProcessing().
+int32_t dvh_set_double_precision(DVH_Plugin p, int32_t enable) {
+  if (!p) return 0;
+  auto* ps = (DVH_PluginState*)p;
+  std::lock_guard<std::mutex> g(ps->mtx);
+  const int32 size = enable ? kSample64 : kSample32;
+  if (ps->sampleSize == size) return 1;
+  if (ps->processor->canProcessSampleSize(size) != kResultTrue) return 0;
+  ps->sampleSize = size;
+  ps->setup.symbolicSampleSize = size;
+  return restartProcessing(ps);
+}
 
-  float* outChannels[2] = { outL, outR };
-  const float* inChannels[2] = { inL, inR };
+int32_t dvh_supports_double_precision(DVH_Plugin p) {
+  if (!p) return 0;
+  auto* ps = (DVH_PluginState*)p;
+  return ps->processor->canProcessSampleSize(kSample64) == kResultTrue ? 1 : 0;
+}
 
-  AudioBusBuffers inBuf{};
-  inBuf.numChannels = 2;
-  inBuf.channelBuffers32 = const_cast<float**>(inChannels);
+// Return the latency the processor introduces, in samples. Plug‑ins
+// with lookahead report it here so hosts can delay parallel signal
+// paths to match.
+int32_t dvh_get_latency_samples(DVH_Plugin p) {
+  if (!p) return 0;
+  auto* ps = (DVH_PluginState*)p;
+  std::lock_guard<std::mutex> g(ps->mtx);
+  return (int32_t)ps->processor->getLatencySamples();
+}
 
-  AudioBusBuffers outBuf{};
-  outBuf.numChannels = 2;
-  outBuf.channelBuffers32 = outChannels;
+// Return the tail length the processor reports, in samples, or -1 if
+// its tail is infinite.
+int32_t dvh_get_tail_samples(DVH_Plugin p) {
+  if (!p) return 0;
+  auto* ps = (DVH_PluginState*)p;
+  std::lock_guard<std::mutex> g(ps->mtx);
+  const uint32 tail = ps->processor->getTailSamples();
+  if (tail == kInfiniteTail || tail > 0x7FFFFFFFu) return -1;
+  return (int32_t)tail;
+}
 
-  ProcessData data{};
-  data.processMode = ps->setup.processMode;
-  data.symbolicSampleSize = ps->setup.symbolicSampleSize;
-  data.numSamples = num_frames;
+// Add one queued event to the VST3 event or parameter lists. Returns
+// false if the lists are full.
+static bool deliverEvent(DVH_PluginState* ps, const DVH_QueuedEvent& q) {
+  if (q.kind == DVH_QueuedEvent::kParam) {
+    int32 idx = 0;
+    IParamValueQueue* pq = ps->inputParamChanges.addParameterData((ParamID)q.channelOrParam, idx);
+    return pq && pq->addPoint(q.sampleOffset, q.value, idx) == kResultTrue;
+  }
+  Vst::Event e{};
+  e.sampleOffset = q.sampleOffset;
+  if (q.kind == DVH_QueuedEvent::kNoteOn) {
+    e.type = Vst::Event::kNoteOnEvent;
+    e.noteOn.channel = (int16)q.channelOrParam;
+    e.noteOn.pitch = (int16)q.note;
+    e.noteOn.velocity = q.value;
+  } else {
+    e.type = Vst::Event::kNoteOffEvent;
+    e.noteOff.channel = (int16)q.channelOrParam;
+    e.noteOff.pitch = (int16)q.note;
+    e.noteOff.velocity = q.value;
+  }
+  return ps->inputEvents.addEvent(e) == kResultTrue;
+}
 
-  data.numInputs = 1;
-  data.inputs = &inBuf;
-  data.numOutputs = 1;
-  data.outputs = &outBuf;
+// Move everything due in this block into the VST3 event and parameter
+// lists. Runs on the audio thread before process(). Events at or past
+// num_frames are held back and their offsets moved to the next block,
+// so callers that split a long block into slices keep exact timing.
+// Events that do not fit are counted as dropped.
+static void drainEvents(DVH_PluginState* ps, int32 numFrames) {
+  auto drop = [&] { ps->pending.dropped.fetch_add(1, std::memory_order_relaxed); };
+  int32 keep = 0;
+  for (int32 i = 0; i < ps->numDeferred; ++i) {
+    DVH_QueuedEvent q = ps->deferred[i];
+    if (q.sampleOffset < numFrames) {
+      if (!deliverEvent(ps, q)) drop();
+    } else {
+      q.sampleOffset -= numFrames;
+      ps->deferred[keep++] = q;
+    }
+  }
+  ps->numDeferred = keep;
+  DVH_QueuedEvent q;
+  while (ps->pending.pop(q)) {
+    if (q.sampleOffset < numFrames) {
+      if (!deliverEvent(ps, q)) drop();
+    } else if (ps->numDeferred < DVH_PluginState::kMaxDeferred) {
+      q.sampleOffset -= numFrames;
+      ps->deferred[ps->numDeferred++] = q;
+    } else {
+      drop();
+    }
+  }
+}
 
-  data.inputParameterChanges = &ps->inputParamChanges;
-  data.outputParameterChanges = &ps->outputParamChanges;
-  data.inputEvents = &ps->inputEvents;
+// Order queued events by sample offset as VST3 requires. Events are
+// usually queued in order already; insertion sort is cheap then and
+// keeps events with equal offsets in the order they were queued.
+static void sortEvents(EventList& list) {
+  const int32 n = list.getEventCount();
+  for (int32 i = 1; i < n; ++i) {
+    Vst::Event e = *list.getEventByIndex(i);
+    int32 j = i;
+    for (; j > 0 && list.getEventByIndex(j - 1)->sampleOffset > e.sampleOffset; --j)
+      *list.getEventByIndex(j) = *list.getEventByIndex(j - 1);
+    *list.getEventByIndex(j) = e;
+  }
+}
+
+} // extern "C"
+
+// Point a bus at the channel array matching the sample type.
+static void setChannels(AudioBusBuffers& bus, void** channels, float*) { bus.channelBuffers32 = (float**)channels; }
+static void setChannels(AudioBusBuffers& bus, void** channels, double*) { bus.channelBuffers64 = (double**)channels; }
+
+// Process one block on the cached bus buffers. inputs[b][c] and
+// outputs[b][c] are the planar channels of bus b; missing buses and
+// null channels read silence or write to scratch memory, which limits
+// num_frames to max_block. T must match the sample size set up with
+// dvh_set_double_precision(). Parameter changes and MIDI events are
+// consumed each block. Must be called with ps->mtx held.
+template <typename T>
+static int32_t processBuses(DVH_PluginState* ps,
+                            const T* const* const* inputs, int32 numIn,
+                            T* const* const* outputs, int32 numOut,
+                            int32 numFrames) {
+  constexpr int32 size = sizeof(T) == sizeof(double) ? kSample64 : kSample32;
+  if (!ps->active || ps->setup.symbolicSampleSize != size) return 0;
+  const int32 maxBlock = (int32)ps->silence.size();
+  void** in = ps->inChannels.data();
+  for (int32 b = 0; b < (int32)ps->inBuses.size(); ++b) {
+    const T* const* src = b < numIn && inputs ? inputs[b] : nullptr;
+    const int32 channels = ps->inBuses[b].numChannels;
+    uint64 silent = 0;
+    for (int32 c = 0; c < channels; ++c) {
+      const T* ch = src ? src[c] : nullptr;
+      if (!ch) {
+        if (numFrames > maxBlock) return 0;
+        ch = (const T*)ps->silence.data();
+        if (c < 64) silent |= uint64(1) << c;
+      }
+      in[c] = const_cast<T*>(ch);
+    }
+    setChannels(ps->inBuses[b], in, (T*)nullptr);
+    ps->inBuses[b].silenceFlags = silent;
+    in += channels;
+  }
+  void** out = ps->outChannels.data();
+  double* scratch = ps->scratch.data();
+  for (int32 b = 0; b < (int32)ps->outBuses.size(); ++b) {
+    T* const* dst = b < numOut && outputs ? outputs[b] : nullptr;
+    const int32 channels = ps->outBuses[b].numChannels;
+    for (int32 c = 0; c < channels; ++c, scratch += maxBlock) {
+      T* ch = dst ? dst[c] : nullptr;
+      if (!ch) {
+        if (numFrames > maxBlock) return 0;
+        ch = (T*)scratch;
+      }
+      out[c] = ch;
+    }
+    setChannels(ps->outBuses[b], out, (T*)nullptr);
+    out += channels;
+    ps->outBuses[b].silenceFlags = 0;
+  }
+
+  ProcessData& data = ps->data;
+  data.processMode = ps->setup.processMode;
+  data.symbolicSampleSize = size;
+  data.numSamples = numFrames;
+
+  drainEvents(ps, numFrames);
+  sortEvents(ps->inputEvents);
 
   auto r = ps->processor->process(data);
 
@@ -266,32 +646,139 @@ int32_t dvh_process_stereo_f32(DVH_Plugin p,
   return toOK(r);
 }
 
-// Queue a note on event for the plug‑in. The event is added to the
-// inputEvents list and consumed on the next process() call. Returns
-// 1 on success.
-int32_t dvh_note_on(DVH_Plugin p, int32_t channel, int32_t note, float velocity) {
+template <typename T>
+static int32_t processMulti(DVH_Plugin p,
+                            const T* const* const* inputs, int32_t numIn,
+                            T* const* const* outputs, int32_t numOut,
+                            int32_t numFrames) {
+  if (!p || numFrames <= 0 || numIn < 0 || numOut < 0) return 0;
+  auto* ps = (DVH_PluginState*)p;
+  std::lock_guard<std::mutex> g(ps->mtx);
+  return processBuses(ps, inputs, numIn, outputs, numOut, numFrames);
+}
+
+// Process the main buses only. Other buses are fed silence and their
+// output is discarded. A mono main output is copied to both outputs.
+template <typename T>
+static int32_t processStereo(DVH_Plugin p, const T* inL, const T* inR, T* outL, T* outR, int32_t numFrames) {
+  if (!p || !outL || !outR || numFrames <= 0) return 0;
+  auto* ps = (DVH_PluginState*)p;
+  std::lock_guard<std::mutex> g(ps->mtx);
+  if (!ps->active) return 0;
+
+  ps->stereoIn[0] = inL;
+  ps->stereoIn[1] = inR;
+  ps->stereoOut[0] = outL;
+  ps->stereoOut[1] = outR;
+  const T* const* in = (const T* const*)ps->stereoIn.data();
+  T* const* out = (T* const*)ps->stereoOut.data();
+  const int32 r = processBuses(ps, &in, 1, &out, 1, numFrames);
+  if (!r) return 0;
+
+  const int32 mainOut = ps->outBuses.empty() ? 0 : ps->outBuses[0].numChannels;
+  if (mainOut == 0) {
+    std::memset(outL, 0, sizeof(T) * numFrames);
+    std::memset(outR, 0, sizeof(T) * numFrames);
+  } else if (mainOut == 1) {
+    std::memcpy(outR, outL, sizeof(T) * numFrames);
+  }
+  return r;
+}
+
+extern "C" {
+
+int32_t dvh_process_f32(DVH_Plugin p,
+                        const float* const* const* inputs, int32_t num_input_buses,
+                        float* const* const* outputs, int32_t num_output_buses,
+                        int32_t num_frames) {
+  return processMulti(p, inputs, num_input_buses, outputs, num_output_buses, num_frames);
+}
+
+int32_t dvh_process_f64(DVH_Plugin p,
+                        const double* const* const* inputs, int32_t num_input_buses,
+                        double* const* const* outputs, int32_t num_output_buses,
+                        int32_t num_frames) {
+  return processMulti(p, inputs, num_input_buses, outputs, num_output_buses, num_frames);
+}
+
+int32_t dvh_process_stereo_f32(DVH_Plugin p,
+                               const float* inL, const float* inR,
+                               float* outL, float* outR,
+                               int32_t num_frames) {
+  return processStereo(p, inL, inR, outL, outR, num_frames);
+}
+
+int32_t dvh_process_stereo_f64(DVH_Plugin p,
+                               const double* inL, const double* inR,
+                               double* outL, double* outR,
+                               int32_t num_frames) {
+  return processStereo(p, inL, inR, outL, outR, num_frames);
+}
+
+// Request a speaker arrangement for an audio bus, applied on the next
+// dvh_resume(). Returns 1 if the bus exists.
+int32_t dvh_set_bus_arrangement(DVH_Plugin p, int32_t is_input, int32_t bus, uint64_t speaker_arrangement) {
+  if (!p || bus < 0) return 0;
+  auto* ps = (DVH_PluginState*)p;
+  std::lock_guard<std::mutex> g(ps->mtx);
+  if (bus >= ps->component->getBusCount(kAudio, is_input ? kInput : kOutput)) return 0;
+  auto& requested = is_input ? ps->requestedIn : ps->requestedOut;
+  if ((int32)requested.size() <= bus) requested.resize(bus + 1, DVH_PluginState::kDefaultArrangement);
+  requested[bus] = (SpeakerArrangement)speaker_arrangement;
+  return 1;
+}
+
+int32_t dvh_get_bus_count(DVH_Plugin p, int32_t is_input) {
   if (!p) return 0;
   auto* ps = (DVH_PluginState*)p;
-  Vst::Event e{};
-  e.type = Vst::Event::kNoteOnEvent;
-  e.sampleOffset = 0;
-  e.noteOn.channel = (int16)channel;
-  e.noteOn.pitch = (int16)note;
-  e.noteOn.velocity = velocity;
-  return toOK(ps->inputEvents.addEvent(e));
+  return ps->component->getBusCount(kAudio, is_input ? kInput : kOutput);
 }
 
-// Queue a note off event for the plug‑in. Returns 1 on success.
-int32_t dvh_note_off(DVH_Plugin p, int32_t channel, int32_t note, float velocity) {
+int32_t dvh_get_bus_channels(DVH_Plugin p, int32_t is_input, int32_t bus) {
   if (!p) return 0;
   auto* ps = (DVH_PluginState*)p;
-  Vst::Event e{};
-  e.type = Vst::Event::kNoteOffEvent;
-  e.sampleOffset = 0;
-  e.noteOff.channel = (int16)channel;
-  e.noteOff.pitch = (int16)note;
-  e.noteOff.velocity = velocity;
-  return toOK(ps->inputEvents.addEvent(e));
+  std::lock_guard<std::mutex> g(ps->mtx);
+  if (ps->active) {
+    const auto& buses = is_input ? ps->inBuses : ps->outBuses;
+    return bus >= 0 && bus < (int32)buses.size() ? buses[bus].numChannels : 0;
+  }
+  SpeakerArrangement arr = SpeakerArr::kEmpty;
+  if (bus < 0 || ps->processor->getBusArrangement(is_input ? kInput : kOutput, bus, arr) != kResultTrue) return 0;
+  return SpeakerArr::getChannelCount(arr);
+}
+
+int32_t dvh_get_silence_flags(DVH_Plugin p, int32_t is_input, int32_t bus, uint64_t* flags) {
+  if (!p || !flags) return 0;
+  auto* ps = (DVH_PluginState*)p;
+  std::lock_guard<std::mutex> g(ps->mtx);
+  const auto& buses = is_input ? ps->inBuses : ps->outBuses;
+  if (!ps->active || bus < 0 || bus >= (int32)buses.size()) return 0;
+  *flags = buses[bus].silenceFlags;
+  return 1;
+}
+
+// Queue a note event for the plug‑in. The event goes through the
+// plug‑in's lock‑free event ring and reaches the processor on the
+// next process() call, at sample_offset frames into the block. Never
+// blocks; returns 0 if the ring is full and the event was dropped.
+static int32_t queueNote(DVH_Plugin p, DVH_QueuedEvent::Kind kind, int32_t sample_offset,
+                         int32_t channel, int32_t note, float velocity) {
+  if (!p || sample_offset < 0) return 0;
+  auto* ps = (DVH_PluginState*)p;
+  return ps->pending.push({kind, sample_offset, channel, note, velocity}) ? 1 : 0;
+}
+
+int32_t dvh_note_on_at(DVH_Plugin p, int32_t sample_offset, int32_t channel, int32_t note, float velocity) {
+  return queueNote(p, DVH_QueuedEvent::kNoteOn, sample_offset, channel, note, velocity);
+}
+int32_t dvh_note_off_at(DVH_Plugin p, int32_t sample_offset, int32_t channel, int32_t note, float velocity) {
+  return queueNote(p, DVH_QueuedEvent::kNoteOff, sample_offset, channel, note, velocity);
+}
+int32_t dvh_note_on(DVH_Plugin p, int32_t channel, int32_t note, float velocity) {
+  return dvh_note_on_at(p, 0, channel, note, velocity);
+}
+int32_t dvh_note_off(DVH_Plugin p, int32_t channel, int32_t note, float velocity) {
+  return dvh_note_off_at(p, 0, channel, note, velocity);
 }
 
 // Retrieve the number of parameters defined by the plug‑in’s
@@ -346,21 +833,30 @@ float dvh_get_param_normalized(DVH_Plugin p, int32_t param_id) {
   return (float)ps->controller->getParamNormalized((ParamID)param_id);
 }
 
-// Set a normalized value for a parameter. The value is also enqueued
-// into the inputParamChanges list so the processor sees the change on
-// the next process() call. Returns 1 on success.
-int32_t dvh_set_param_normalized(DVH_Plugin p, int32_t param_id, float normalized) {
-  if (!p) return 0;
+// Set a normalized value for a parameter. The value is also queued
+// through the event ring so the processor sees the change on the next
+// process() call, sample_offset frames into the block. Each parameter
+// keeps every point queued for a block, ordered by offset, so the
+// processor receives the full automation curve. Returns 1 on success
+// or 0 if the ring is full and the change was dropped.
+int32_t dvh_set_param_at(DVH_Plugin p, int32_t param_id, int32_t sample_offset, float normalized) {
+  if (!p || sample_offset < 0) return 0;
   auto* ps = (DVH_PluginState*)p;
   if (!ps->controller) return 0;
 
   ps->controller->setParamNormalized((ParamID)param_id, normalized);
+  return ps->pending.push({DVH_QueuedEvent::kParam, sample_offset, param_id, 0, normalized}) ? 1 : 0;
+}
 
-  int32 idx = 0;
-  IParamValueQueue* q = ps->inputParamChanges.addParameterData((ParamID)param_id, idx);
-  if (!q) return 0;
-  q->addPoint(0, normalized, idx);
-  return 1;
+int32_t dvh_set_param_normalized(DVH_Plugin p, int32_t param_id, float normalized) {
+  return dvh_set_param_at(p, param_id, 0, normalized);
+}
+
+// Number of notes and parameter changes dropped because the event ring
+// or the VST3 event lists were full.
+int64_t dvh_get_dropped_event_count(DVH_Plugin p) {
+  if (!p) return 0;
+  return ((DVH_PluginState*)p)->pending.dropped.load(std::memory_order_relaxed);
 }
 
 } // extern "C"
\ No newline at end of file
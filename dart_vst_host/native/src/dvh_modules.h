@@ -0,0 +1,41 @@
+// Copyright (c) 2025
+//
+// Internal helpers shared by the translation units of dart_vst_host:
+// the process‑wide host context and the cache of loaded VST3 modules.
+// Not part of the public C API.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "public.sdk/source/vst/hosting/module.h"
+#include "public.sdk/source/vst/hosting/hostclasses.h"
+
+// A loaded VST3 module together with an index of its factory classes.
+// Entries are shared by every plug‑in instantiated from the module and
+// the library is unloaded when the last of them is destroyed.
+struct DVH_ModuleEntry {
+  std::shared_ptr<VST3::Hosting::Module> module;
+  std::vector<VST3::Hosting::ClassInfo> classes;
+  std::unordered_map<std::string, size_t> byUid;
+  int32_t firstAudioModule{-1};
+
+  // Find a class by UID string, or the first Audio Module Class when
+  // uid is null or empty. Returns nullptr if there is no match.
+  const VST3::Hosting::ClassInfo* find(const char* uid) const;
+};
+
+// Canonical form of a module path, used as the cache and scan key.
+// Falls back to the path as given if it cannot be resolved.
+std::string dvhCanonicalPath(const char* pathUtf8);
+
+// Return the cached module for a path, loading it on first use.
+// Returns nullptr if the module cannot be loaded.
+std::shared_ptr<DVH_ModuleEntry> dvhAcquireModule(const char* pathUtf8);
+
+// HostApplication shared by all hosts and the plug‑in scanner. The
+// first reference installs it as the global plug‑in context.
+std::shared_ptr<Steinberg::Vst::HostApplication> dvhAcquireHostContext();
@@ -0,0 +1,463 @@
+// Copyright (c) 2025
+//
+// Plug‑in scanner for the Dart VST host. Walks directories for VST3
+// bundles, loads each one and records its classes, bus layouts and
+// parameter counts in a compact binary index. The index is written in
+// a position independent layout so that it can be memory mapped and
+// browsed at startup without loading a single module. Bundles are
+// keyed by canonical path and modification time; rescans reuse the
+// records of unchanged bundles and only load the ones that changed.
+
+#include "dart_vst_host.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#include "pluginterfaces/vst/ivstaudioprocessor.h"
+#include "pluginterfaces/vst/ivsteditcontroller.h"
+#include "public.sdk/source/vst/hosting/plugprovider.h"
+
+#include "dvh_modules.h"
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+namespace fs = std::filesystem;
+
+namespace {
+
+// On‑disk layout. All offsets are relative to the start of the file and
+// all strings live NUL terminated in one blob; string offset 0 is the
+// empty string. The file is a local cache, so native byte order is used
+// and any layout change bumps kIndexVersion to force a full rescan.
+constexpr char kIndexMagic[8] = {'D', 'V', 'H', 'S', 'C', 'A', 'N', 0};
+constexpr uint32_t kIndexVersion = 1;
+constexpr int kStringFields = DVH_SCAN_SUBCATEGORIES + 1;
+constexpr int kIntFields = DVH_SCAN_PARAM_COUNT + 1;
+
+struct IndexHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t bundleCount;
+  uint32_t classCount;
+  uint32_t stringBytes;
+  uint64_t bundlesOffset;
+  uint64_t classesOffset;
+  uint64_t stringsOffset;
+};
+
+struct IndexBundle {
+  enum : uint32_t { kLoadFailed = 1 };
+  uint32_t path;
+  uint32_t firstClass;
+  uint32_t classCount;
+  uint32_t flags;
+  int64_t mtime;
+};
+
+struct IndexClass {
+  uint32_t bundle;
+  uint32_t strings[kStringFields]; // DVH_SCAN_PATH is unused, see bundle
+  int32_t ints[kIntFields];
+};
+
+// A bundle as seen by the scanner, either freshly loaded or carried
+// over from the previous index.
+struct ScannedClass {
+  std::string strings[kStringFields];
+  int32_t ints[kIntFields] = {};
+};
+
+struct ScannedBundle {
+  std::string path;
+  int64_t mtime{0};
+  bool failed{false};
+  std::vector<ScannedClass> classes;
+};
+
+// Read only memory mapping of an index file.
+class MappedFile {
+ public:
+  ~MappedFile() { close(); }
+
+  bool open(const char* pathUtf8) {
+#ifdef _WIN32
+    file_ = CreateFileW(fs::u8path(pathUtf8).wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0) return false;
+    mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_) return false;
+    data_ = (const uint8_t*)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+    size_ = (size_t)size.QuadPart;
+#else
+    int fd = ::open(pathUtf8, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+      ::close(fd);
+      return false;
+    }
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    data_ = (const uint8_t*)p;
+    size_ = (size_t)st.st_size;
+#endif
+    return data_ != nullptr;
+  }
+
+  void close() {
+#ifdef _WIN32
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+    mapping_ = nullptr;
+    file_ = INVALID_HANDLE_VALUE;
+#else
+    if (data_) munmap((void*)data_, size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  const uint8_t* data_{nullptr};
+  size_t size_{0};
+#ifdef _WIN32
+  HANDLE file_{INVALID_HANDLE_VALUE};
+  HANDLE mapping_{nullptr};
+#endif
+};
+
+} // namespace
+
+// An opened index. Tables point straight into the mapping.
+struct DVH_ScanIndexState {
+  MappedFile file;
+  const IndexHeader* header{nullptr};
+  const IndexBundle* bundles{nullptr};
+  const IndexClass* classes{nullptr};
+  const char* strings{nullptr};
+
+  bool open(const char* pathUtf8) {
+    if (!file.open(pathUtf8)) return false;
+    const size_t size = file.size();
+    if (size < sizeof(IndexHeader)) return false;
+    header = (const IndexHeader*)file.data();
+    if (std::memcmp(header->magic, kIndexMagic, sizeof(kIndexMagic)) != 0) return false;
+    if (header->version != kIndexVersion) return false;
+    auto fits = [size](uint64_t offset, uint64_t bytes) {
+      return offset <= size && bytes <= size - offset;
+    };
+    if (!fits(header->bundlesOffset, (uint64_t)header->bundleCount * sizeof(IndexBundle))) return false;
+    if (!fits(header->classesOffset, (uint64_t)header->classCount * sizeof(IndexClass))) return false;
+    if (!fits(header->stringsOffset, header->stringBytes) || header->stringBytes == 0) return false;
+    if (header->bundlesOffset % alignof(IndexBundle) || header->classesOffset % alignof(IndexClass)) return false;
+    bundles = (const IndexBundle*)(file.data() + header->bundlesOffset);
+    classes = (const IndexClass*)(file.data() + header->classesOffset);
+    strings = (const char*)(file.data() + header->stringsOffset);
+    // The blob ends in NUL, so every in‑range offset is a terminated string.
+    if (strings[header->stringBytes - 1] != 0) return false;
+    for (uint32_t i = 0; i < header->bundleCount; ++i) {
+      const auto& b = bundles[i];
+      if (b.firstClass > header->classCount || b.classCount > header->classCount - b.firstClass) return false;
+    }
+    for (uint32_t i = 0; i < header->classCount; ++i) {
+      if (classes[i].bundle >= header->bundleCount) return false;
+    }
+    return true;
+  }
+
+  const char* string(uint32_t offset) const {
+    return offset < header->stringBytes ? strings + offset : "";
+  }
+};
+
+namespace {
+
+bool hasBundleExtension(const fs::path& p) {
+  std::string ext = p.extension().u8string();
+  std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+  return ext == ".vst3";
+}
+
+// Collect VST3 bundles below dir. A bundle passed directly is accepted
+// as is. Bundles are not descended into.
+void findBundles(const fs::path& dir, std::vector<std::string>& out) {
+  std::error_code ec;
+  if (hasBundleExtension(dir) && fs::exists(dir, ec)) {
+    out.push_back(dvhCanonicalPath(dir.u8string().c_str()));
+    return;
+  }
+  const auto opts = fs::directory_options::skip_permission_denied | fs::directory_options::follow_directory_symlink;
+  fs::recursive_directory_iterator it(dir, opts, ec), end;
+  for (; !ec && it != end; it.increment(ec)) {
+    if (!hasBundleExtension(it->path())) continue;
+    out.push_back(dvhCanonicalPath(it->path().u8string().c_str()));
+    if (it->is_directory(ec)) it.disable_recursion_pending();
+  }
+}
+
+// Newest modification time of a bundle and everything inside it, so a
+// replaced binary invalidates the record even if the bundle directory
+// itself was not touched.
+int64_t bundleMTime(const std::string& pathUtf8) {
+  const fs::path path = fs::u8path(pathUtf8);
+  std::error_code ec;
+  auto newest = fs::last_write_time(path, ec);
+  if (ec) return 0;
+  if (fs::is_directory(path, ec)) {
+    fs::recursive_directory_iterator it(path, fs::directory_options::skip_permission_denied, ec), end;
+    for (; !ec && it != end; it.increment(ec)) {
+      std::error_code tec;
+      auto t = it->last_write_time(tec);
+      if (!tec && t > newest) newest = t;
+    }
+  }
+  return (int64_t)newest.time_since_epoch().count();
+}
+
+// Instantiate an audio module just long enough to read its bus layout
+// and parameter count.
+void describeComponent(const DVH_ModuleEntry& entry, const VST3::Hosting::ClassInfo& ci, ScannedClass& c) {
+  auto provider = std::make_shared<Vst::PlugProvider>(entry.module->getFactory(), ci, true);
+  if (!provider->initialize()) return;
+  IPtr<IComponent> component = provider->getComponentPtr();
+  if (!component) return;
+  c.ints[DVH_SCAN_AUDIO_INPUT_BUSES] = component->getBusCount(kAudio, kInput);
+  c.ints[DVH_SCAN_AUDIO_OUTPUT_BUSES] = component->getBusCount(kAudio, kOutput);
+  c.ints[DVH_SCAN_EVENT_INPUT_BUSES] = component->getBusCount(kEvent, kInput);
+  BusInfo info{};
+  if (c.ints[DVH_SCAN_AUDIO_INPUT_BUSES] > 0 && component->getBusInfo(kAudio, kInput, 0, info) == kResultTrue)
+    c.ints[DVH_SCAN_MAIN_INPUT_CHANNELS] = info.channelCount;
+  if (c.ints[DVH_SCAN_AUDIO_OUTPUT_BUSES] > 0 && component->getBusInfo(kAudio, kOutput, 0, info) == kResultTrue)
+    c.ints[DVH_SCAN_MAIN_OUTPUT_CHANNELS] = info.channelCount;
+  if (IPtr<IEditController> controller = provider->getControllerPtr())
+    c.ints[DVH_SCAN_PARAM_COUNT] = controller->getParameterCount();
+}
+
+ScannedBundle scanBundle(const std::string& path, int64_t mtime) {
+  ScannedBundle b;
+  b.path = path;
+  b.mtime = mtime;
+  b.failed = true;
+  try {
+    auto entry = dvhAcquireModule(path.c_str());
+    if (!entry) return b;
+    for (const auto& ci : entry->classes) {
+      ScannedClass c;
+      c.strings[DVH_SCAN_UID] = ci.ID().toString();
+      c.strings[DVH_SCAN_NAME] = ci.name();
+      c.strings[DVH_SCAN_VENDOR] = ci.vendor();
+      c.strings[DVH_SCAN_VERSION] = ci.version();
+      c.strings[DVH_SCAN_CATEGORY] = ci.category();
+      c.strings[DVH_SCAN_SUBCATEGORIES] = ci.subCategoriesString();
+      if (ci.category() == std::string(kVstAudioEffectClass)) describeComponent(*entry, ci, c);
+      b.classes.push_back(std::move(c));
+    }
+    b.failed = false;
+  } catch (...) {
+    b.classes.clear();
+  }
+  return b;
+}
+
+// Records of the previous index by path, for incremental rescans.
+std::unordered_map<std::string, ScannedBundle> readPrevious(const char* indexPath) {
+  std::unordered_map<std::string, ScannedBundle> out;
+  DVH_ScanIndexState idx;
+  if (!idx.open(indexPath)) return out;
+  for (uint32_t i = 0; i < idx.header->bundleCount; ++i) {
+    const auto& ib = idx.bundles[i];
+    ScannedBundle b;
+    b.path = idx.string(ib.path);
+    b.mtime = ib.mtime;
+    b.failed = (ib.flags & IndexBundle::kLoadFailed) != 0;
+    for (uint32_t k = 0; k < ib.classCount; ++k) {
+      const auto& ic = idx.classes[ib.firstClass + k];
+      ScannedClass c;
+      for (int f = 0; f < kStringFields; ++f) c.strings[f] = idx.string(ic.strings[f]);
+      std::memcpy(c.ints, ic.ints, sizeof(c.ints));
+      b.classes.push_back(std::move(c));
+    }
+    out.emplace(b.path, std::move(b));
+  }
+  return out;
+}
+
+// Write the index to a temporary file next to indexPath and move it
+// into place, so readers never see a partially written index.
+bool writeIndex(const char* indexPath, const std::vector<ScannedBundle>& bundles) {
+  std::string blob(1, '\0');
+  std::unordered_map<std::string, uint32_t> interned;
+  auto intern = [&](const std::string& s) -> uint32_t {
+    if (s.empty()) return 0;
+    auto it = interned.find(s);
+    if (it != interned.end()) return it->second;
+    const uint32_t offset = (uint32_t)blob.size();
+    blob.append(s).push_back('\0');
+    interned.emplace(s, offset);
+    return offset;
+  };
+
+  std::vector<IndexBundle> ib;
+  std::vector<IndexClass> ic;
+  ib.reserve(bundles.size());
+  for (const auto& b : bundles) {
+    IndexBundle r{};
+    r.path = intern(b.path);
+    r.firstClass = (uint32_t)ic.size();
+    r.classCount = (uint32_t)b.classes.size();
+    r.flags = b.failed ? IndexBundle::kLoadFailed : 0;
+    r.mtime = b.mtime;
+    for (const auto& c : b.classes) {
+      IndexClass rc{};
+      rc.bundle = (uint32_t)ib.size();
+      for (int f = 0; f < kStringFields; ++f) rc.strings[f] = intern(c.strings[f]);
+      std::memcpy(rc.ints, c.ints, sizeof(rc.ints));
+      ic.push_back(rc);
+    }
+    ib.push_back(r);
+  }
+
+  IndexHeader h{};
+  std::memcpy(h.magic, kIndexMagic, sizeof(kIndexMagic));
+  h.version = kIndexVersion;
+  h.bundleCount = (uint32_t)ib.size();
+  h.classCount = (uint32_t)ic.size();
+  h.stringBytes = (uint32_t)blob.size();
+  h.bundlesOffset = sizeof(IndexHeader);
+  h.classesOffset = h.bundlesOffset + ib.size() * sizeof(IndexBundle);
+  h.stringsOffset = h.classesOffset + ic.size() * sizeof(IndexClass);
+
+  const fs::path target = fs::u8path(indexPath);
+  fs::path tmp = target;
+  tmp += ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    out.write((const char*)&h, sizeof(h));
+    out.write((const char*)ib.data(), (std::streamsize)(ib.size() * sizeof(IndexBundle)));
+    out.write((const char*)ic.data(), (std::streamsize)(ic.size() * sizeof(IndexClass)));
+    out.write(blob.data(), (std::streamsize)blob.size());
+    if (!out) return false;
+  }
+  std::error_code ec;
+  fs::rename(tmp, target, ec);
+  if (ec) fs::remove(tmp, ec);
+  return !ec;
+}
+
+} // namespace
+
+extern "C" {
+
+int32_t dvh_scan_plugins(const char* const* dirs_utf8, int32_t num_dirs,
+                         const char* index_path_utf8, int32_t num_threads) {
+  if (!index_path_utf8 || num_dirs < 0 || (num_dirs > 0 && !dirs_utf8)) return -1;
+
+  std::vector<std::string> paths;
+  if (num_dirs == 0) {
+    for (const auto& p : VST3::Hosting::Module::getModulePaths()) paths.push_back(dvhCanonicalPath(p.c_str()));
+  } else {
+    for (int32_t i = 0; i < num_dirs; ++i) {
+      if (dirs_utf8[i]) findBundles(fs::u8path(dirs_utf8[i]), paths);
+    }
+  }
+  std::sort(paths.begin(), paths.end());
+  paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+  auto previous = readPrevious(index_path_utf8);
+  std::vector<ScannedBundle> bundles(paths.size());
+  std::vector<size_t> todo;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    const int64_t mtime = bundleMTime(paths[i]);
+    auto it = previous.find(paths[i]);
+    if (it != previous.end() && it->second.mtime == mtime) {
+      bundles[i] = std::move(it->second);
+    } else {
+      bundles[i].path = paths[i];
+      bundles[i].mtime = mtime;
+      todo.push_back(i);
+    }
+  }
+
+  if (!todo.empty()) {
+    // Plug‑ins query the global context while initializing.
+    auto context = dvhAcquireHostContext();
+    size_t threads = num_threads > 0 ? (size_t)num_threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, todo.size());
+    std::atomic<size_t> next{0};
+    auto work = [&] {
+      for (size_t k; (k = next.fetch_add(1, std::memory_order_relaxed)) < todo.size();) {
+        auto& b = bundles[todo[k]];
+        b = scanBundle(b.path, b.mtime);
+      }
+    };
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; ++t) pool.emplace_back(work);
+    work();
+    for (auto& t : pool) t.join();
+  }
+
+  if (!writeIndex(index_path_utf8, bundles)) return -1;
+  return (int32_t)todo.size();
+}
+
+DVH_ScanIndex dvh_open_scan_index(const char* index_path_utf8) {
+  if (!index_path_utf8) return nullptr;
+  auto* idx = new DVH_ScanIndexState();
+  if (!idx->open(index_path_utf8)) {
+    delete idx;
+    return nullptr;
+  }
+  return (DVH_ScanIndex)idx;
+}
+
+void dvh_close_scan_index(DVH_ScanIndex index) {
+  delete (DVH_ScanIndexState*)index;
+}
+
+int32_t dvh_scan_index_count(DVH_ScanIndex index) {
+  if (!index) return 0;
+  return (int32_t)((DVH_ScanIndexState*)index)->header->classCount;
+}
+
+const char* dvh_scan_index_string(DVH_ScanIndex index, int32_t entry, int32_t field) {
+  if (!index || field < 0 || field >= kStringFields) return nullptr;
+  auto* idx = (DVH_ScanIndexState*)index;
+  if (entry < 0 || (uint32_t)entry >= idx->header->classCount) return nullptr;
+  const auto& c = idx->classes[entry];
+  if (field == DVH_SCAN_PATH) return idx->string(idx->bundles[c.bundle].path);
+  return idx->string(c.strings[field]);
+}
+
+int32_t dvh_scan_index_int(DVH_ScanIndex index, int32_t entry, int32_t field) {
+  if (!index || field < 0 || field >= kIntFields) return 0;
+  auto* idx = (DVH_ScanIndexState*)index;
+  if (entry < 0 || (uint32_t)entry >= idx->header->classCount) return 0;
+  return idx->classes[entry].ints[field];
+}
+
+} // extern "C"
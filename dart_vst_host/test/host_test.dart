@@ -87,6 +87,46 @@ void main() {
     }
   });
 
+  test('hosts share one context and can be disposed in any order', () {
+    final a = VstHost.create(
+        sampleRate: 48000, maxBlock: 512, dylibPath: libFile.absolute.path);
+    final b = VstHost.create(
+        sampleRate: 44100, maxBlock: 256, dylibPath: libFile.absolute.path);
+    a.dispose();
+    try {
+      expect(() => b.load('/nonexistent/plugin.vst3'),
+          throwsA(isA<StateError>()));
+    } finally {
+      b.dispose();
+    }
+  });
+
+  test('plug‑in index scan is incremental', () {
+    final dir = Directory.systemTemp.createTempSync('dvh_scan');
+    try {
+      Directory('${dir.path}/plugins/Broken.vst3').createSync(recursive: true);
+      final indexPath = '${dir.path}/plugins.idx';
+      final path = libFile.absolute.path;
+      expect(VstPluginIndex.open(indexPath, dylibPath: path), isNull);
+
+      final dirs = ['${dir.path}/plugins'];
+      expect(VstPluginIndex.scan(indexPath: indexPath, directories: dirs, dylibPath: path), 1);
+      // Unchanged bundles, including ones that failed to load, are not
+      // loaded again.
+      expect(VstPluginIndex.scan(indexPath: indexPath, directories: dirs, dylibPath: path), 0);
+
+      final index = VstPluginIndex.open(indexPath, dylibPath: path)!;
+      try {
+        expect(index.length, 0);
+        expect(index.plugins, isEmpty);
+      } finally {
+        index.close();
+      }
+    } finally {
+      dir.deleteSync(recursive: true);
+    }
+  });
+
   test('audio generation and save to file', () {
     final host = VstHost.create(
         sampleRate: 48000, maxBlock: 512, dylibPath: libFile.absolute.path);
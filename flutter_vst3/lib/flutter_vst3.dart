@@ -9,4 +9,5 @@ library flutter_vst3;
 
 export 'src/flutter_vst3_bridge.dart';
 export 'src/flutter_vst3_callbacks.dart';
-export 'src/flutter_vst3_parameters.dart';
\ No newline at end of file
+export 'src/flutter_vst3_parameters.dart';
+export 'src/flutter_vst3_ipc.dart';
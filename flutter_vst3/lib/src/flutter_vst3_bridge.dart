@@ -1,4 +1,5 @@
 import 'dart:ffi' as ffi;
+import 'dart:typed_data';
 
 /// Abstract interface that all Dart VST3 processors must implement
 abstract class VST3Processor {
@@ -25,10 +26,24 @@ abstract class VST3Processor {
   void dispose();
 }
 
+/// Planar audio slots owned by the C++ bridge (DartVST3AudioSlots in
+/// dart_vst3_bridge.h). Each plane is 64-byte aligned.
+final class DartVST3AudioSlots extends ffi.Struct {
+  external ffi.Pointer<ffi.Float> inputL;
+  external ffi.Pointer<ffi.Float> inputR;
+  external ffi.Pointer<ffi.Float> outputL;
+  external ffi.Pointer<ffi.Float> outputR;
+
+  @ffi.Int32()
+  external int capacity;
+}
+
 /// Callback function signatures for FFI
 typedef DartInitializeProcessorNative = ffi.Void Function(ffi.Double, ffi.Int32);
 typedef DartProcessAudioNative = ffi.Void Function(ffi.Pointer<ffi.Float>, ffi.Pointer<ffi.Float>, ffi.Pointer<ffi.Float>, ffi.Pointer<ffi.Float>, ffi.Int32);
 typedef DartSetParameterNative = ffi.Void Function(ffi.Int32, ffi.Double);
+typedef DartSetParametersBatchNative = ffi.Void Function(ffi.Pointer<ffi.Int32>, ffi.Pointer<ffi.Double>, ffi.Int32);
+typedef DartProcessSlotsNative = ffi.Void Function(ffi.Pointer<DartVST3AudioSlots>, ffi.Int32);
 typedef DartGetParameterNative = ffi.Double Function(ffi.Int32);
 typedef DartGetParameterCountNative = ffi.Int32 Function();
 typedef DartResetNative = ffi.Void Function();
@@ -38,6 +53,17 @@ typedef DartDisposeNative = ffi.Void Function();
 class VST3Bridge {
   static VST3Processor? _processor;
 
+  // Views of the bridge's audio slots, rebuilt only when the planes move
+  // or the block size changes. The slots struct itself never moves, but
+  // re-initializing with a larger block reallocates the planes.
+  static int _slotPlanes = 0;
+  static int _slotCapacity = 0;
+  static int _slotFrames = -1;
+  static Float32List _slotInL = Float32List(0);
+  static Float32List _slotInR = Float32List(0);
+  static Float32List _slotOutL = Float32List(0);
+  static Float32List _slotOutR = Float32List(0);
+
   /// Register a Dart VST3 processor with the bridge
   /// This must be called before the VST3 plugin can process audio
   static void registerProcessor(VST3Processor processor) {
@@ -51,6 +77,8 @@ class VST3Bridge {
     if (_processor == null) {
       throw StateError('CRITICAL VST3 BRIDGE FAILURE: Cannot initialize - no processor registered! Call VST3Bridge.registerProcessor() before using the plugin!');
     }
+    _slotPlanes = 0;
+    _slotFrames = -1;
     _processor!.initialize(sampleRate, maxBlockSize);
   }
 
@@ -65,26 +93,39 @@ class VST3Bridge {
       throw StateError('CRITICAL VST3 BRIDGE FAILURE: No processor registered! Audio processing CANNOT continue without a Dart processor! Call VST3Bridge.registerProcessor() first!');
     }
 
-    // Convert C pointers to Dart lists
-    final inL = inputL.asTypedList(numSamples);
-    final inR = inputR.asTypedList(numSamples);
-    final outL = outputL.asTypedList(numSamples);
-    final outR = outputR.asTypedList(numSamples);
-
-    // Convert float arrays to double arrays for Dart processing
-    final dartInL = List<double>.generate(numSamples, (i) => inL[i].toDouble());
-    final dartInR = List<double>.generate(numSamples, (i) => inR[i].toDouble());
-    final dartOutL = List<double>.filled(numSamples, 0.0);
-    final dartOutR = List<double>.filled(numSamples, 0.0);
-
-    // Process through Dart processor
-    _processor!.processStereo(dartInL, dartInR, dartOutL, dartOutR);
-
-    // Convert back to C float arrays
-    for (int i = 0; i < numSamples; i++) {
-      outL[i] = dartOutL[i];
-      outR[i] = dartOutR[i];
+    // Float32List is a List<double>, so the processor works on the C
+    // buffers directly. Hosts may process in place; copy the inputs then.
+    var inL = inputL.asTypedList(numSamples);
+    var inR = inputR.asTypedList(numSamples);
+    if (inputL == outputL) inL = Float32List.fromList(inL);
+    if (inputR == outputR) inR = Float32List.fromList(inR);
+
+    _processor!.processStereo(inL, inR,
+        outputL.asTypedList(numSamples), outputR.asTypedList(numSamples));
+  }
+
+  /// Process the block in the bridge's audio slots
+  /// Called from C++ instead of processAudio; the slots are viewed in
+  /// place, so nothing is copied or converted on the Dart side
+  static void processSlots(ffi.Pointer<DartVST3AudioSlots> slots, int numSamples) {
+    if (_processor == null) {
+      throw StateError('CRITICAL VST3 BRIDGE FAILURE: No processor registered! Audio processing CANNOT continue without a Dart processor! Call VST3Bridge.registerProcessor() first!');
+    }
+
+    final planes = slots.ref;
+    if (planes.inputL.address != _slotPlanes ||
+        planes.capacity != _slotCapacity ||
+        numSamples != _slotFrames) {
+      _slotInL = planes.inputL.asTypedList(numSamples);
+      _slotInR = planes.inputR.asTypedList(numSamples);
+      _slotOutL = planes.outputL.asTypedList(numSamples);
+      _slotOutR = planes.outputR.asTypedList(numSamples);
+      _slotPlanes = planes.inputL.address;
+      _slotCapacity = planes.capacity;
+      _slotFrames = numSamples;
     }
+
+    _processor!.processStereo(_slotInL, _slotInR, _slotOutL, _slotOutR);
   }
 
   /// Set parameter value
@@ -93,6 +134,18 @@ class VST3Bridge {
     _processor?.setParameter(paramId, normalizedValue);
   }
 
+  /// Set several parameter values at once
+  /// Called from C++ with every parameter change of a process block
+  static void setParametersBatch(ffi.Pointer<ffi.Int32> paramIds,
+                                 ffi.Pointer<ffi.Double> normalizedValues,
+                                 int count) {
+    final processor = _processor;
+    if (processor == null) return;
+    for (int i = 0; i < count; i++) {
+      processor.setParameter(paramIds[i], normalizedValues[i]);
+    }
+  }
+
   /// Get parameter value
   /// Called from C++ when VST3 needs current parameter value
   static double getParameter(int paramId) {
@@ -21,6 +21,18 @@ typedef ProcessAudioDart = void Function(ffi.Pointer<ffi.Float> inputL,
 typedef SetParameterC = ffi.Void Function(ffi.Int32 paramId, ffi.Double normalizedValue);
 typedef SetParameterDart = void Function(int paramId, double normalizedValue);
 
+typedef SetParametersBatchC = ffi.Void Function(ffi.Pointer<ffi.Int32> paramIds,
+                                               ffi.Pointer<ffi.Double> normalizedValues,
+                                               ffi.Int32 count);
+typedef SetParametersBatchDart = void Function(ffi.Pointer<ffi.Int32> paramIds,
+                                              ffi.Pointer<ffi.Double> normalizedValues,
+                                              int count);
+
+typedef ProcessSlotsC = ffi.Void Function(ffi.Pointer<DartVST3AudioSlots> slots,
+                                         ffi.Int32 numSamples);
+typedef ProcessSlotsDart = void Function(ffi.Pointer<DartVST3AudioSlots> slots,
+                                        int numSamples);
+
 typedef GetParameterC = ffi.Double Function(ffi.Int32 paramId);
 typedef GetParameterDart = double Function(int paramId);
 
@@ -49,6 +61,8 @@ final class DartVST3Callbacks extends ffi.Struct {
   external ffi.Pointer<ffi.NativeFunction<GetParameterCountC>> getParameterCount;
   external ffi.Pointer<ffi.NativeFunction<ResetC>> reset;
   external ffi.Pointer<ffi.NativeFunction<DisposeC>> dispose;
+  external ffi.Pointer<ffi.NativeFunction<SetParametersBatchC>> setParametersBatch;
+  external ffi.Pointer<ffi.NativeFunction<ProcessSlotsC>> processSlots;
 }
 
 /// Register Dart callbacks with C++ layer
@@ -97,6 +111,10 @@ void registerVST3Callbacks({required String pluginId}) {
       VST3Bridge.reset);
     callbacks.ref.dispose = ffi.Pointer.fromFunction<DisposeC>(
       VST3Bridge.dispose);
+    callbacks.ref.setParametersBatch = ffi.Pointer.fromFunction<SetParametersBatchC>(
+      VST3Bridge.setParametersBatch);
+    callbacks.ref.processSlots = ffi.Pointer.fromFunction<ProcessSlotsC>(
+      VST3Bridge.processSlots);
 
     // Register callbacks with C++ bridge
     final result = registerCallbacks(instance, callbacks);
@@ -0,0 +1,478 @@
+/// Shared-memory transport for out-of-process Dart processors.
+///
+/// The native side of a plugin built from `plugin_processor_native`
+/// starts the `_processor` executable with `--shared-audio`, then maps
+/// one region per plug-in instance holding a header, per-block event
+/// lists and planar audio slots and attaches it over stdio. Audio never
+/// touches the pipes; they only carry init, attach and terminate.
+///
+/// Both transports deliver parameter changes and notes with the block
+/// they belong to, stamped with a frame offset. [processBlock] applies
+/// them at those frames. Over the pipes, [PipeMessageReader] reassembles
+/// each request from however many chunks the pipe splits it into and
+/// [processPipeBlock] answers it; its audio is planar too and is
+/// processed where the reader buffered it.
+///
+/// Every attached channel is served on its own worker isolate with its
+/// own processor, so one process can run several instances concurrently.
+/// Workers sleep on their request doorbell, leaving the main isolate free
+/// to attach further channels or notice the host closing stdin and exit.
+///
+/// The layout mirrors `native/include/dart_vst3_ipc.h`.
+library;
+
+import 'dart:ffi' as ffi;
+import 'dart:io';
+import 'dart:isolate';
+import 'dart:typed_data';
+import 'package:ffi/ffi.dart';
+
+/// Per-block callbacks for a processor served by the bridge.
+///
+/// The lists passed to [process] hold the frames between one event and
+/// the next, so a block with events arrives in several calls. Over shared
+/// memory they are views of the shared slots, only valid for the
+/// duration of the call. Notes are dropped when [noteOn] and [noteOff]
+/// are not given.
+class SharedAudioHandler {
+  final void Function(Float32List inputL, Float32List inputR,
+      Float32List outputL, Float32List outputR) process;
+  final void Function(int paramId, double value) setParameter;
+  final void Function(int channel, int pitch, double velocity)? noteOn;
+  final void Function(int channel, int pitch, double velocity)? noteOff;
+
+  const SharedAudioHandler(
+      {required this.process,
+      required this.setParameter,
+      this.noteOn,
+      this.noteOff});
+}
+
+/// Builds the handler on a channel's worker isolate once the region is
+/// mapped. Called once per attached instance.
+typedef SharedAudioFactory = SharedAudioHandler Function(
+    double sampleRate, int maxBlock);
+
+/// Bytes per event record, see DartVst3IpcEvent.
+const dartVst3EventSize = 24;
+
+const _eventParameter = 0;
+const _eventNoteOn = 1;
+const _eventNoteOff = 2;
+
+/// Runs [handler] over one block, applying each of the [eventCount]
+/// packed event records in [events] at its frame.
+///
+/// Events must be in frame order, as the host sends them.
+void processBlock(SharedAudioHandler handler, ByteData events, int eventCount,
+    Float32List inputL, Float32List inputR, Float32List outputL,
+    Float32List outputR) {
+  final frames = inputL.length;
+  var start = 0;
+  for (var i = 0; i < eventCount; i++) {
+    final at = i * dartVst3EventSize;
+    final offset = events.getUint32(at, Endian.host);
+    final end = offset < frames ? offset : frames;
+    if (end > start) {
+      _render(handler, inputL, inputR, outputL, outputR, start, end);
+      start = end;
+    }
+    final id = events.getInt32(at + 8, Endian.host);
+    final channel = events.getInt32(at + 12, Endian.host);
+    final value = events.getFloat64(at + 16, Endian.host);
+    switch (events.getUint32(at + 4, Endian.host)) {
+      case _eventParameter:
+        handler.setParameter(id, value);
+      case _eventNoteOn:
+        handler.noteOn?.call(channel, id, value);
+      case _eventNoteOff:
+        handler.noteOff?.call(channel, id, value);
+    }
+  }
+  if (start < frames) {
+    _render(handler, inputL, inputR, outputL, outputR, start, frames);
+  }
+}
+
+/// Bytes before the events in a pipe CMD_PROCESS request: command, three
+/// reserved bytes, frame count and event count. The padding keeps the
+/// planar audio that follows the events 4-byte aligned.
+const dartVst3PipeRequestHeaderSize = 12;
+
+/// Bytes before the planar audio in a pipe CMD_PROCESS reply: command and
+/// three reserved bytes.
+const dartVst3PipeReplyHeaderSize = 4;
+
+/// Processes the pipe CMD_PROCESS request at the start of [request] and
+/// returns the reply to write back.
+///
+/// The request's audio is viewed where it lies in [request] and [handler]
+/// renders straight into the reply, so no sample is converted or copied
+/// again after [PipeMessageReader] buffers it. [request] must start on a
+/// 4-byte boundary of its buffer.
+Uint8List processPipeBlock(SharedAudioHandler handler, ByteData request) {
+  final frames = request.getInt32(4, Endian.host);
+  final eventCount = request.getInt32(8, Endian.host);
+  final audioStart =
+      dartVst3PipeRequestHeaderSize + eventCount * dartVst3EventSize;
+  final events = ByteData.sublistView(
+      request, dartVst3PipeRequestHeaderSize, audioStart);
+  final input = request.buffer
+      .asFloat32List(request.offsetInBytes + audioStart, frames * 2);
+
+  final reply = Uint8List(dartVst3PipeReplyHeaderSize + frames * 8);
+  reply[0] = request.getUint8(0);
+  final output =
+      reply.buffer.asFloat32List(dartVst3PipeReplyHeaderSize, frames * 2);
+
+  processBlock(
+      handler,
+      events,
+      eventCount,
+      Float32List.sublistView(input, 0, frames),
+      Float32List.sublistView(input, frames),
+      Float32List.sublistView(output, 0, frames),
+      Float32List.sublistView(output, frames));
+  return reply;
+}
+
+/// Splits the bytes read from the host's pipe into whole messages.
+///
+/// A pipe hands a write over in as many chunks as it likes, and a
+/// CMD_PROCESS request with events is far larger than the pipe's atomic
+/// write size, so a chunk may hold part of a message or several. [add]
+/// buffers each chunk; [next] then returns the messages that are
+/// complete, framed on the command byte and, for CMD_PROCESS, the frame
+/// and event counts in the header.
+///
+/// Messages start on a 4-byte boundary, as [processPipeBlock] needs. Each
+/// one is a view of the reader's buffer, valid until the next call to
+/// [add] or [next].
+class PipeMessageReader {
+  var _buffer = Uint8List(4096);
+  late var _bytes = ByteData.sublistView(_buffer);
+  var _start = 0;
+  var _end = 0;
+
+  /// Appends [bytes] read from the pipe.
+  void add(List<int> bytes) {
+    final pending = _end - _start;
+    if (pending + bytes.length > _buffer.length) {
+      var size = _buffer.length;
+      while (size < pending + bytes.length) {
+        size *= 2;
+      }
+      _buffer = Uint8List(size)..setRange(0, pending, _buffer, _start);
+      _bytes = ByteData.sublistView(_buffer);
+      _start = 0;
+      _end = pending;
+    } else if (_end + bytes.length > _buffer.length) {
+      _moveToFront();
+    }
+    _buffer.setRange(_end, _end + bytes.length, bytes);
+    _end += bytes.length;
+  }
+
+  /// The next complete message, or null until more bytes arrive.
+  ByteData? next() {
+    final size = _messageSize();
+    if (size < 0 || _end - _start < size) return null;
+    if (_start % 4 != 0) _moveToFront();
+    final message = ByteData.sublistView(_buffer, _start, _start + size);
+    _start += size;
+    if (_start == _end) _start = _end = 0;
+    return message;
+  }
+
+  // Bytes in the message at _start, or -1 until enough of its header
+  // has arrived to tell.
+  int _messageSize() {
+    final available = _end - _start;
+    if (available == 0) return -1;
+    switch (_buffer[_start]) {
+      case _cmdInit:
+        return 9; // command and sample rate
+      case _cmdProcess:
+        if (available < dartVst3PipeRequestHeaderSize) return -1;
+        final frames = _bytes.getInt32(_start + 4, Endian.host);
+        final eventCount = _bytes.getInt32(_start + 8, Endian.host);
+        if (frames < 0 || eventCount < 0 || eventCount > _maxEvents) {
+          throw FormatException(
+              'Bad CMD_PROCESS header: $frames frames, $eventCount events');
+        }
+        return dartVst3PipeRequestHeaderSize +
+            eventCount * dartVst3EventSize +
+            frames * 8;
+      case _cmdAttach:
+        if (available < 5) return -1;
+        return 5 + _bytes.getUint32(_start + 1, Endian.little);
+      default:
+        return 1; // terminate, or a command with no payload
+    }
+  }
+
+  void _moveToFront() {
+    _buffer.setRange(0, _end - _start, _buffer, _start);
+    _end -= _start;
+    _start = 0;
+  }
+}
+
+void _render(SharedAudioHandler handler, Float32List inputL,
+    Float32List inputR, Float32List outputL, Float32List outputR, int start,
+    int end) {
+  if (start == 0 && end == inputL.length) {
+    handler.process(inputL, inputR, outputL, outputR);
+    return;
+  }
+  handler.process(
+      Float32List.sublistView(inputL, start, end),
+      Float32List.sublistView(inputR, start, end),
+      Float32List.sublistView(outputL, start, end),
+      Float32List.sublistView(outputR, start, end));
+}
+
+const _cmdInit = 0x01;
+const _cmdProcess = 0x02;
+const _cmdAttach = 0x04;
+const _cmdTerminate = 0xFF;
+
+// Region layout, see DartVst3IpcHeader and DartVst3IpcBlock.
+const _magic = 0x44563349;
+const _version = 4;
+const _offMagic = 0;
+const _offVersion = 4;
+const _offMaxBlock = 8;
+const _offSlotSets = 12;
+const _offSampleRate = 16;
+const _offCommand = 24;
+const _offRequest = 64;
+const _offResponse = 128;
+const _headerSize = 192;
+const _offNumSamples = 0; // within a slot set
+const _offEventCount = 4;
+const _offEvents = 8;
+const _maxEvents = 256;
+const _blockSize = 6208;
+const _slotAlign = 16;
+const _commandDetach = 1;
+
+const _oRdwr = 2;
+const _protReadWrite = 3;
+const _mapShared = 1;
+
+/// Whether the host started this executable for the shared-memory
+/// transport rather than the pipe protocol.
+bool usesSharedAudio(List<String> args) => args.contains('--shared-audio');
+
+/// Serves audio over shared memory if [args] ask for it.
+///
+/// Returns false immediately when they don't, so the caller can run its
+/// pipe loop instead. Otherwise answers init and attach on stdio, serves
+/// every attached channel until the host sends terminate or closes
+/// stdin, and exits the process.
+Future<bool> serveSharedAudio(
+    List<String> args, SharedAudioFactory factory) async {
+  if (!usesSharedAudio(args)) return false;
+
+  final errors = ReceivePort()
+    ..listen((error) {
+      stderr.writeln('SHARED AUDIO WORKER FAILED: $error');
+      exit(1);
+    });
+
+  final messages = PipeMessageReader();
+  await for (final bytes in stdin) {
+    messages.add(bytes);
+    for (var message = messages.next();
+        message != null;
+        message = messages.next()) {
+      switch (message.getUint8(0)) {
+        case _cmdInit:
+          stdout.add([_cmdInit]); // ACK
+          await stdout.flush();
+        case _cmdAttach:
+          final locator = String.fromCharCodes(
+              Uint8List.sublistView(message, 5));
+          final ready = ReceivePort();
+          await Isolate.spawn(
+              _serve, _WorkerStart(locator, factory, ready.sendPort),
+              onError: errors.sendPort);
+          await ready.first;
+          ready.close();
+          stdout.add([_cmdAttach]); // ACK
+          await stdout.flush();
+        case _cmdTerminate:
+          exit(0);
+      }
+    }
+  }
+  exit(0);
+}
+
+class _WorkerStart {
+  final String locator;
+  final SharedAudioFactory factory;
+  final SendPort ready;
+
+  _WorkerStart(this.locator, this.factory, this.ready);
+}
+
+void _serve(_WorkerStart start) {
+  final region = _SharedRegion.open(start.locator);
+  final handler = start.factory(region.sampleRate, region.maxBlock);
+  start.ready.send(null);
+  region.serve(handler);
+}
+
+typedef _MmapC = ffi.Pointer<ffi.Void> Function(ffi.Pointer<ffi.Void>,
+    ffi.IntPtr, ffi.Int32, ffi.Int32, ffi.Int32, ffi.Int64);
+typedef _MmapDart = ffi.Pointer<ffi.Void> Function(
+    ffi.Pointer<ffi.Void>, int, int, int, int, int);
+typedef _MunmapC = ffi.Int32 Function(ffi.Pointer<ffi.Void>, ffi.IntPtr);
+typedef _MunmapDart = int Function(ffi.Pointer<ffi.Void>, int);
+typedef _CloseC = ffi.Int32 Function(ffi.Int32);
+typedef _CloseDart = int Function(int);
+typedef _OpenC = ffi.Int32 Function(ffi.Pointer<Utf8>, ffi.Int32);
+typedef _OpenDart = int Function(ffi.Pointer<Utf8>, int);
+typedef _SemOpenC = ffi.Pointer<ffi.Void> Function(ffi.Pointer<Utf8>, ffi.Int32);
+typedef _SemOpenDart = ffi.Pointer<ffi.Void> Function(ffi.Pointer<Utf8>, int);
+typedef _SemC = ffi.Int32 Function(ffi.Pointer<ffi.Void>);
+typedef _SemDart = int Function(ffi.Pointer<ffi.Void>);
+
+/// The worker's mapping of the region and its two doorbells.
+class _SharedRegion {
+  static final _libc = ffi.DynamicLibrary.process();
+  static final _mmap = _libc.lookupFunction<_MmapC, _MmapDart>('mmap');
+  static final _munmap = _libc.lookupFunction<_MunmapC, _MunmapDart>('munmap');
+  static final _semWait = _libc.lookupFunction<_SemC, _SemDart>('sem_wait');
+  static final _semPost = _libc.lookupFunction<_SemC, _SemDart>('sem_post');
+
+  final ffi.Pointer<ffi.Uint8> _base;
+  final ffi.Pointer<ffi.Void> _request;
+  final ffi.Pointer<ffi.Void> _response;
+  final bool _named;
+  final int maxBlock;
+  final int slotSets;
+  final double sampleRate;
+
+  _SharedRegion._(this._base, this._request, this._response, this._named)
+      : maxBlock = _u32(_base, _offMaxBlock),
+        slotSets = _u32(_base, _offSlotSets),
+        sampleRate = (_base + _offSampleRate).cast<ffi.Double>().value;
+
+  /// Maps the region at [locator]: a /proc fd path on Linux, a shm_open
+  /// name on macOS.
+  factory _SharedRegion.open(String locator) {
+    final named = Platform.isMacOS;
+    final open = _libc.lookupFunction<_OpenC, _OpenDart>(named ? 'shm_open' : 'open');
+    final fd = using((arena) => open(locator.toNativeUtf8(allocator: arena), _oRdwr));
+    if (fd < 0) throw StateError('Cannot open shared audio region $locator');
+
+    // Map the header first to learn the slot size.
+    final header = _map(fd, _headerSize);
+    if (_u32(header, _offMagic) != _magic || _u32(header, _offVersion) != _version) {
+      throw StateError('Shared audio region $locator has an unknown layout');
+    }
+    final size = _sizeFor(_u32(header, _offMaxBlock), _u32(header, _offSlotSets));
+    _munmap(header.cast(), _headerSize);
+    final base = _map(fd, size);
+    _libc.lookupFunction<_CloseC, _CloseDart>('close')(fd);
+
+    if (!named) {
+      // Linux keeps process-shared semaphores inside the header.
+      return _SharedRegion._(
+          base, (base + _offRequest).cast(), (base + _offResponse).cast(), false);
+    }
+    final semOpen = _libc.lookupFunction<_SemOpenC, _SemOpenDart>('sem_open');
+    final request = using((arena) => semOpen('$locator.q'.toNativeUtf8(allocator: arena), 0));
+    final response = using((arena) => semOpen('$locator.r'.toNativeUtf8(allocator: arena), 0));
+    if (request.address == -1 || response.address == -1) {
+      throw StateError('Cannot open doorbells for $locator');
+    }
+    return _SharedRegion._(base, request, response, true);
+  }
+
+  static ffi.Pointer<ffi.Uint8> _map(int fd, int size) {
+    final p = _mmap(ffi.nullptr, size, _protReadWrite, _mapShared, fd, 0);
+    if (p.address == -1) throw StateError('Cannot map shared audio region');
+    return p.cast();
+  }
+
+  static int _strideFor(int maxBlock) =>
+      (maxBlock + _slotAlign - 1) ~/ _slotAlign * _slotAlign;
+
+  static int _setSizeFor(int maxBlock) =>
+      _blockSize + 4 * _strideFor(maxBlock) * ffi.sizeOf<ffi.Float>();
+
+  static int _sizeFor(int maxBlock, int slotSets) =>
+      _headerSize + slotSets * _setSizeFor(maxBlock);
+
+  static int _u32(ffi.Pointer<ffi.Uint8> base, int offset) =>
+      (base + offset).cast<ffi.Uint32>().value;
+
+  /// Processes blocks until the host detaches the channel. Requests are
+  /// served in order, request k using slot set k % [slotSets].
+  void serve(SharedAudioHandler handler) {
+    final sets = [
+      for (var s = 0; s < slotSets; s++)
+        _SlotSet(_base + _headerSize + s * _setSizeFor(maxBlock), maxBlock)
+    ];
+    var next = 0;
+
+    while (true) {
+      while (_semWait(_request) != 0) {}
+      if (_u32(_base, _offCommand) == _commandDetach) {
+        _semPost(_response);
+        _close();
+        return;
+      }
+
+      final set = sets[next];
+      next = (next + 1) % slotSets;
+      set.process(handler);
+
+      _semPost(_response);
+    }
+  }
+
+  void _close() {
+    if (_named) {
+      final semClose = _libc.lookupFunction<_SemC, _SemDart>('sem_close');
+      semClose(_request);
+      semClose(_response);
+    }
+    _munmap(_base.cast(), _sizeFor(maxBlock, slotSets));
+  }
+}
+
+/// One slot set: the events and audio of a single request.
+class _SlotSet {
+  final ffi.Pointer<ffi.Uint8> _block;
+  final ByteData _events;
+  final List<ffi.Pointer<ffi.Float>> _slots;
+  var _frames = -1;
+  late Float32List _inL, _inR, _outL, _outR;
+
+  _SlotSet(this._block, int maxBlock)
+      : _events = ByteData.sublistView(
+            (_block + _offEvents).asTypedList(_maxEvents * dartVst3EventSize)),
+        _slots = [
+          for (var i = 0; i < 4; i++)
+            (_block + _blockSize).cast<ffi.Float>() +
+                i * _SharedRegion._strideFor(maxBlock)
+        ];
+
+  void process(SharedAudioHandler handler) {
+    final n = _SharedRegion._u32(_block, _offNumSamples);
+    if (n != _frames) {
+      _frames = n;
+      _inL = _slots[0].asTypedList(n);
+      _inR = _slots[1].asTypedList(n);
+      _outL = _slots[2].asTypedList(n);
+      _outR = _slots[3].asTypedList(n);
+    }
+    processBlock(handler, _events, _SharedRegion._u32(_block, _offEventCount),
+        _inL, _inR, _outL, _outR);
+  }
+}
@@ -0,0 +1,205 @@
+// Measures the round-trip latency of one audio block between a native
+// processor and its Dart `_processor` executable, over the stdio pipe
+// protocol and over the shared-memory transport in dart_vst3_ipc.h.
+// Both runs talk to the same executable, so the difference is the cost
+// of the transport alone.
+//
+// Build and run from this directory:
+//
+//   c++ -std=c++17 -O2 -I../include ipc_roundtrip.cpp -o ipc_roundtrip
+//   ./ipc_roundtrip <path/to/plugin_processor> [block] [blocks]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "dart_vst3_ipc.h"
+
+namespace {
+
+constexpr uint8_t CMD_INIT = 0x01;
+constexpr uint8_t CMD_PROCESS = 0x02;
+constexpr uint8_t CMD_ATTACH = 0x04;
+constexpr uint8_t CMD_TERMINATE = 0xFF;
+
+constexpr int kWarmupBlocks = 500;
+
+struct Child {
+  pid_t pid = -1;
+  FILE* to = nullptr;
+  FILE* from = nullptr;
+};
+
+bool spawn(Child& c, const char* exe, bool shared, double sampleRate) {
+  int to_child[2], from_child[2];
+  if (pipe(to_child) == -1 || pipe(from_child) == -1) return false;
+  c.pid = fork();
+  if (c.pid == -1) return false;
+  if (c.pid == 0) {
+    dup2(to_child[0], STDIN_FILENO);
+    dup2(from_child[1], STDOUT_FILENO);
+    close(to_child[0]);
+    close(to_child[1]);
+    close(from_child[0]);
+    close(from_child[1]);
+    if (shared) execl(exe, exe, "--shared-audio", nullptr);
+    else execl(exe, exe, nullptr);
+    _exit(1);
+  }
+  close(to_child[0]);
+  close(from_child[1]);
+  c.to = fdopen(to_child[1], "wb");
+  c.from = fdopen(from_child[0], "rb");
+
+  uint8_t init_msg[9];
+  init_msg[0] = CMD_INIT;
+  memcpy(&init_msg[1], &sampleRate, sizeof(double));
+  fwrite(init_msg, 1, sizeof(init_msg), c.to);
+  fflush(c.to);
+  uint8_t ack = 0;
+  return fread(&ack, 1, 1, c.from) == 1 && ack == CMD_INIT;
+}
+
+bool attach(Child& c, const std::string& locator) {
+  std::vector<uint8_t> msg(5 + locator.size());
+  uint32_t length = uint32_t(locator.size());
+  msg[0] = CMD_ATTACH;
+  memcpy(&msg[1], &length, sizeof(uint32_t));
+  memcpy(&msg[5], locator.data(), locator.size());
+  fwrite(msg.data(), 1, msg.size(), c.to);
+  fflush(c.to);
+  uint8_t ack = 0;
+  return fread(&ack, 1, 1, c.from) == 1 && ack == CMD_ATTACH;
+}
+
+void stop(Child& c) {
+  if (c.to) {
+    fputc(CMD_TERMINATE, c.to);
+    fflush(c.to);
+    fclose(c.to);
+  }
+  if (c.from) fclose(c.from);
+  if (c.pid > 0) waitpid(c.pid, nullptr, 0);
+  c = Child{};
+}
+
+// Same framing as plugin_processor_native.cpp.template, with no events:
+// a 12-byte header and planar audio each way.
+bool pipeBlock(Child& c, const float* inL, const float* inR, float* outL, float* outR, int n,
+               std::vector<uint8_t>& msg, std::vector<uint8_t>& reply) {
+  const int32_t events = 0;
+  const size_t plane = size_t(n) * sizeof(float);
+  msg.assign(12 + 2 * plane, 0);
+  msg[0] = CMD_PROCESS;
+  memcpy(&msg[4], &n, sizeof(int32_t));
+  memcpy(&msg[8], &events, sizeof(int32_t));
+  memcpy(&msg[12], inL, plane);
+  memcpy(&msg[12 + plane], inR, plane);
+  if (fwrite(msg.data(), 1, msg.size(), c.to) != msg.size()) return false;
+  fflush(c.to);
+  reply.resize(4 + 2 * plane);
+  if (fread(reply.data(), 1, reply.size(), c.from) != reply.size() || reply[0] != CMD_PROCESS) return false;
+  memcpy(outL, &reply[4], plane);
+  memcpy(outR, &reply[4 + plane], plane);
+  return true;
+}
+
+bool shmBlock(DartVst3SharedBlock& shm, const float* inL, const float* inR, float* outL, float* outR, int n) {
+  memcpy(shm.inL(), inL, n * sizeof(float));
+  memcpy(shm.inR(), inR, n * sizeof(float));
+  if (!shm.roundTrip(uint32_t(n))) return false;
+  memcpy(outL, shm.outL(), n * sizeof(float));
+  memcpy(outR, shm.outR(), n * sizeof(float));
+  return true;
+}
+
+void report(const char* name, std::vector<double>& us) {
+  std::sort(us.begin(), us.end());
+  double sum = 0;
+  for (double v : us) sum += v;
+  auto pct = [&](double p) { return us[std::min(us.size() - 1, size_t(p * us.size()))]; };
+  printf("%-6s mean %8.2f us  p50 %8.2f us  p99 %8.2f us  max %8.2f us\n",
+         name, sum / us.size(), pct(0.50), pct(0.99), us.back());
+}
+
+bool measure(const std::function<bool()>& block, int blocks, std::vector<double>& us) {
+  using clock = std::chrono::steady_clock;
+  for (int i = 0; i < kWarmupBlocks; i++) {
+    if (!block()) return false;
+  }
+  us.clear();
+  us.reserve(blocks);
+  for (int i = 0; i < blocks; i++) {
+    auto t0 = clock::now();
+    if (!block()) return false;
+    us.push_back(std::chrono::duration<double, std::micro>(clock::now() - t0).count());
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <processor executable> [block] [blocks]\n", argv[0]);
+    return 2;
+  }
+  const char* exe = argv[1];
+  const int block = argc > 2 ? atoi(argv[2]) : 512;
+  const int blocks = argc > 3 ? atoi(argv[3]) : 20000;
+  const double sampleRate = 48000.0;
+
+  std::vector<float> inL(block), inR(block), outL(block), outR(block);
+  for (int i = 0; i < block; i++) {
+    inL[i] = 0.5f * float(i % 64) / 64.0f;
+    inR[i] = -inL[i];
+  }
+  printf("%d frames per block, %d blocks\n", block, blocks);
+
+  std::vector<double> us;
+
+  Child piped;
+  if (!spawn(piped, exe, false, sampleRate)) {
+    fprintf(stderr, "pipe transport: %s did not start\n", exe);
+    return 1;
+  }
+  std::vector<uint8_t> msg, reply;
+  bool ok = measure([&] {
+    return pipeBlock(piped, inL.data(), inR.data(), outL.data(), outR.data(), block, msg, reply);
+  }, blocks, us);
+  stop(piped);
+  if (!ok) {
+    fprintf(stderr, "pipe transport failed\n");
+    return 1;
+  }
+  report("pipe", us);
+
+  DartVst3SharedBlock shm;
+  Child mapped;
+  if (!shm.create(uint32_t(block), sampleRate) ||
+      !spawn(mapped, exe, true, sampleRate) || !attach(mapped, shm.locator())) {
+    fprintf(stderr, "shared-memory transport: %s did not start\n", exe);
+    return 1;
+  }
+  shm.unlink();
+  ok = measure([&] {
+    return shmBlock(shm, inL.data(), inR.data(), outL.data(), outR.data(), block);
+  }, blocks, us);
+  shm.detachWorker();
+  stop(mapped);
+  if (!ok) {
+    fprintf(stderr, "shared-memory transport failed\n");
+    return 1;
+  }
+  report("shm", us);
+  return 0;
+}
@@ -228,6 +228,26 @@ function(add_dart_vst3_plugin target_name dart_file)
         )
     endif()
 
+    # Instances served by one Dart processor executable over shared memory.
+    # Defaults to 1 (a process per instance) in the native processor.
+    if(DEFINED DART_VST3_INSTANCES_PER_PROCESS)
+        target_compile_definitions(${target_name} PRIVATE
+            DART_VST3_INSTANCES_PER_PROCESS=${DART_VST3_INSTANCES_PER_PROCESS}
+        )
+    endif()
+
+    # Pipelined Dart processing: one block of latency, no waiting on Dart
+    if(DART_VST3_PIPELINED)
+        target_compile_definitions(${target_name} PRIVATE DART_VST3_PIPELINED=1)
+    endif()
+
+    # Share of each block's duration Dart gets before the block plays dry
+    if(DEFINED DART_VST3_DEADLINE_PERCENT)
+        target_compile_definitions(${target_name} PRIVATE
+            DART_VST3_DEADLINE_PERCENT=${DART_VST3_DEADLINE_PERCENT}
+        )
+    endif()
+
     # Link against SDK and additional libraries
     target_link_libraries(${target_name}
         PRIVATE
@@ -21,12 +21,37 @@
 extern "C" {
 #endif
 
+// Planes in DartVST3AudioSlots start on this boundary
+#define DART_VST3_SLOT_ALIGNMENT 64
+
+// Parameter ids below this are kept in the bridge's snapshot; see
+// dart_vst3_get_parameter
+#define DART_VST3_MAX_SNAPSHOT_PARAMETERS 128
+
+// Planar audio slots owned by the bridge and passed to Dart with every
+// slotted block. Dart views each plane as a Float32List and the processor
+// works on those views in place, so a block reaches Dart and comes back
+// without being converted or interleaved. Dart keeps its views while the
+// planes stay put, which is until the instance is destroyed or
+// re-initialized with a larger block.
+typedef struct {
+    float* input_l;
+    float* input_r;
+    float* output_l;
+    float* output_r;
+    int32_t capacity; // frames per plane
+} DartVST3AudioSlots;
+
 // Function pointer types for Dart callbacks
 typedef void (*DartInitializeProcessorFn)(double sample_rate, int32_t max_block_size);
 typedef void (*DartProcessAudioFn)(const float* input_l, const float* input_r,
                                   float* output_l, float* output_r,
                                   int32_t num_samples);
 typedef void (*DartSetParameterFn)(int32_t param_id, double normalized_value);
+typedef void (*DartSetParametersBatchFn)(const int32_t* param_ids,
+                                         const double* normalized_values,
+                                         int32_t count);
+typedef void (*DartProcessSlotsFn)(const DartVST3AudioSlots* slots, int32_t num_samples);
 typedef double (*DartGetParameterFn)(int32_t param_id);
 typedef int32_t (*DartGetParameterCountFn)(void);
 typedef void (*DartResetFn)(void);
@@ -41,6 +66,11 @@ typedef struct {
     DartGetParameterCountFn get_parameter_count;
     DartResetFn reset;
     DartDisposeFn dispose;
+    // Optional; when null, batches are delivered through set_parameter
+    DartSetParametersBatchFn set_parameters_batch;
+    // Optional; when set, in-place blocks go through the slots instead of
+    // process_audio, as do all blocks if process_audio is null
+    DartProcessSlotsFn process_slots;
 } DartVST3Callbacks;
 
 // Per-plugin instance management
@@ -52,27 +82,53 @@ DART_VST3_API DartVST3Instance* dart_vst3_create_instance(const char* plugin_id)
 // Destroy a plugin instance
 DART_VST3_API int32_t dart_vst3_destroy_instance(DartVST3Instance* instance);
 
-// Register Dart callback functions for a specific plugin instance
+// Register Dart callback functions for a specific plugin instance. The
+// table is copied and published atomically, so registering never blocks
+// a concurrent process or parameter call.
 DART_VST3_API int32_t dart_vst3_register_callbacks(DartVST3Instance* instance, 
                                                    const DartVST3Callbacks* callbacks);
 
-// Initialize the Dart processor
+// Initialize the Dart processor, size the audio slots for max_block_size and
+// re-read the parameter snapshot
 DART_VST3_API int32_t dart_vst3_initialize(DartVST3Instance* instance, 
                                            double sample_rate, int32_t max_block_size);
 
-// Process stereo audio through Dart processor
+// Process stereo audio through Dart processor. Separate input and output
+// buffers are handed to Dart directly; in-place buffers are copied through
+// the audio slots. Returns 0 and passes the input through if no Dart
+// processor is registered.
 DART_VST3_API int32_t dart_vst3_process_stereo(DartVST3Instance* instance,
                                                const float* input_l, const float* input_r,
                                                float* output_l, float* output_r,
                                                int32_t num_samples);
 
-// Set/get parameter values
+// The instance's audio slots, or null before dart_vst3_initialize
+DART_VST3_API const DartVST3AudioSlots* dart_vst3_get_audio_slots(DartVST3Instance* instance);
+
+// Process num_samples frames already written to the input slots, leaving
+// the result in the output slots. For callers that render straight into
+// the slots; returns 0 if the Dart processor does not take slots.
+DART_VST3_API int32_t dart_vst3_process_slots(DartVST3Instance* instance, int32_t num_samples);
+
+// Blocks passed through because no Dart processor was registered
+DART_VST3_API uint64_t dart_vst3_get_bypassed_blocks(DartVST3Instance* instance);
+
+// Set/get parameter values. The bridge keeps ids below
+// DART_VST3_MAX_SNAPSHOT_PARAMETERS in a lock-free snapshot, read from the
+// processor when its callbacks are registered, on dart_vst3_initialize and
+// on dart_vst3_reset, and updated by every set. Getting a value only reads
+// the snapshot and never calls into Dart; ids past the limit or past the
+// processor's parameter count read as 0.
 DART_VST3_API int32_t dart_vst3_set_parameter(DartVST3Instance* instance,
                                               int32_t param_id, double normalized_value);
+DART_VST3_API int32_t dart_vst3_set_parameters_batch(DartVST3Instance* instance,
+                                                     const int32_t* param_ids,
+                                                     const double* normalized_values,
+                                                     int32_t count);
 DART_VST3_API double dart_vst3_get_parameter(DartVST3Instance* instance, int32_t param_id);
 DART_VST3_API int32_t dart_vst3_get_parameter_count(DartVST3Instance* instance);
 
-// Reset processor state
+// Reset processor state and re-read the parameter snapshot
 DART_VST3_API int32_t dart_vst3_reset(DartVST3Instance* instance);
 
 // Dispose resources
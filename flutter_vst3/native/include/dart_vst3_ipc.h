@@ -0,0 +1,722 @@
+// Shared-memory block transport between a native VST3 processor and its
+// out-of-process Dart executable, and the event records both transports
+// carry with each block.
+//
+// The host maps one region holding a header and one or two slot sets.
+// Each set carries the timestamped events for its block and four planar
+// audio slots (in L/R, out L/R). A block is one request: the host fills a
+// set, rings the request doorbell, and Dart processes the set in place
+// and rings the response doorbell. Dart serves requests in order and
+// uses set (request number % slot sets), so with two sets the host can
+// fill one while Dart works on the other. Nothing is allocated,
+// interleaved or written to a pipe on the audio path.
+//
+// Regions are memfds on Linux, located by the child through the host's
+// /proc/<pid>/fd entry, and short-lived shm_open names elsewhere. A
+// locator can be handed to an executable that is already running, so one
+// Dart process may serve the channels of several plug-in instances.
+//
+// Doorbells are process-shared semaphores kept inside the header on Linux
+// (futex-backed in glibc, so an uncontended post is a single atomic) and
+// named semaphores on macOS, which has neither futexes nor unnamed
+// process-shared semaphores.
+//
+// The layout is mirrored in flutter_vst3/lib/src/flutter_vst3_ipc.dart.
+// Change both together and bump kDartVst3IpcVersion.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+constexpr uint32_t kDartVst3IpcMaxParams = 128;
+constexpr uint32_t kDartVst3IpcMaxEvents = 256;  // per block
+
+// Values of DartVst3IpcEvent::kind.
+constexpr uint32_t kDartVst3EventParameter = 0;  // id = parameter, value = normalised
+constexpr uint32_t kDartVst3EventNoteOn = 1;     // id = pitch, value = velocity 0..1
+constexpr uint32_t kDartVst3EventNoteOff = 2;
+
+// A parameter change or note at a frame within its block. The same 24
+// bytes travel in a shared slot set and in a pipe CMD_PROCESS frame.
+struct DartVst3IpcEvent {
+  uint32_t sampleOffset;
+  uint32_t kind;
+  int32_t id;
+  int32_t channel;  // MIDI channel for notes
+  double value;
+};
+
+static_assert(sizeof(DartVst3IpcEvent) == 24, "layout is shared with Dart");
+
+// Events waiting for the block they belong to, in frame order, with
+// offsets counted from the start of that block. Fixed capacity so the
+// audio thread never allocates: when full, a parameter change overwrites
+// the newest queued change to the same parameter and anything else is
+// dropped.
+class DartVst3EventQueue {
+public:
+  void push(const DartVst3IpcEvent& e) {
+    if (count_ == kDartVst3IpcMaxEvents) {
+      if (e.kind == kDartVst3EventParameter) {
+        for (uint32_t i = count_; i-- > 0; ) {
+          if (events_[i].kind == kDartVst3EventParameter && events_[i].id == e.id) {
+            events_[i].value = e.value;
+            return;
+          }
+        }
+      }
+      ++dropped_;
+      return;
+    }
+    // Hosts deliver each queue in order, so this rarely moves anything.
+    uint32_t i = count_++;
+    for (; i > 0 && events_[i - 1].sampleOffset > e.sampleOffset; --i) events_[i] = events_[i - 1];
+    events_[i] = e;
+  }
+
+  // Move every event of other into this queue, delayed by offset frames.
+  void append(DartVst3EventQueue& other, uint32_t offset = 0) {
+    for (uint32_t i = 0; i < other.count_; ++i) {
+      DartVst3IpcEvent e = other.events_[i];
+      e.sampleOffset += offset;
+      push(e);
+    }
+    other.clear();
+  }
+
+  // Copy out the events falling in the next numSamples frames, at most
+  // max of them, and make the rest relative to the block after. Returns
+  // the number copied.
+  uint32_t take(uint32_t numSamples, DartVst3IpcEvent* out, uint32_t max) {
+    uint32_t n = 0;
+    while (n < count_ && n < max && events_[n].sampleOffset < numSamples) {
+      out[n] = events_[n];
+      ++n;
+    }
+    advance(n, numSamples);
+    return n;
+  }
+
+  // Pass over numSamples frames that will not be processed. Their events
+  // move to the start of the next block rather than being lost, so no
+  // parameter value or note-off goes missing.
+  void skip(uint32_t numSamples) { advance(0, numSamples); }
+
+  const DartVst3IpcEvent* data() const { return events_; }
+  uint32_t size() const { return count_; }
+  uint64_t dropped() const { return dropped_; }
+  void clear() { count_ = 0; }
+
+private:
+  // Remove the first n events and shift the rest back by numSamples.
+  void advance(uint32_t n, uint32_t numSamples) {
+    for (uint32_t i = n; i < count_; ++i) {
+      DartVst3IpcEvent e = events_[i];
+      e.sampleOffset = e.sampleOffset > numSamples ? e.sampleOffset - numSamples : 0;
+      events_[i - n] = e;
+    }
+    count_ -= n;
+  }
+
+  DartVst3IpcEvent events_[kDartVst3IpcMaxEvents];
+  uint32_t count_ = 0;
+  uint64_t dropped_ = 0;
+};
+
+// Hands events from any thread to the audio thread without a lock: a
+// bounded multi-producer, single-consumer ring (Vyukov's bounded queue),
+// as DVH_EventRing in dart_vst_host. Producers claim a cell with one CAS
+// and never wait for the consumer; when the ring is full the event is
+// dropped and counted. The audio thread moves events into its
+// DartVst3EventQueue before each block.
+class DartVst3EventRing {
+public:
+  static constexpr uint32_t kCapacity = 4 * kDartVst3IpcMaxEvents;  // power of two
+
+  DartVst3EventRing() {
+    for (uint32_t i = 0; i < kCapacity; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  bool push(const DartVst3IpcEvent& e) {
+    uint32_t pos = head_.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell& c = cells_[pos & (kCapacity - 1)];
+      const int32_t dif = int32_t(c.seq.load(std::memory_order_acquire) - pos);
+      if (dif == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          c.event = e;
+          c.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (dif < 0) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Consumer only.
+  bool pop(DartVst3IpcEvent& e) {
+    const uint32_t pos = tail_.load(std::memory_order_relaxed);
+    Cell& c = cells_[pos & (kCapacity - 1)];
+    if (int32_t(c.seq.load(std::memory_order_acquire) - (pos + 1)) < 0) return false;
+    e = c.event;
+    c.seq.store(pos + kCapacity, std::memory_order_release);
+    tail_.store(pos + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Consumer only. Moves every event pushed so far into queue.
+  void drainInto(DartVst3EventQueue& queue) {
+    DartVst3IpcEvent e;
+    while (pop(e)) queue.push(e);
+  }
+
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+  struct Cell {
+    std::atomic<uint32_t> seq;
+    DartVst3IpcEvent event;
+  };
+  Cell cells_[kCapacity];
+  alignas(64) std::atomic<uint32_t> head_{0};
+  alignas(64) std::atomic<uint32_t> tail_{0};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+#ifndef _WIN32
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+constexpr uint32_t kDartVst3IpcMagic = 0x44563349;  // 'DV3I'
+constexpr uint32_t kDartVst3IpcVersion = 4;
+constexpr uint32_t kDartVst3IpcMaxSlotSets = 2;
+
+// Frames per audio slot are rounded up to this so every slot starts on a
+// cache line.
+constexpr uint32_t kDartVst3IpcSlotAlign = 16;
+
+// Values of DartVst3IpcHeader::command.
+constexpr uint32_t kDartVst3IpcProcess = 0;
+constexpr uint32_t kDartVst3IpcDetach = 1;  // worker acknowledges and exits
+
+struct DartVst3IpcHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t maxBlock;     // frames per audio slot
+  uint32_t slotSets;     // 1, or 2 when pipelined
+  double sampleRate;
+  uint32_t command;      // kDartVst3IpcProcess or kDartVst3IpcDetach
+  uint32_t reserved[9];
+  alignas(64) unsigned char request[64];   // host -> Dart doorbell
+  alignas(64) unsigned char response[64];  // Dart -> host doorbell
+};
+
+// Start of a slot set; its four audio slots follow.
+struct alignas(64) DartVst3IpcBlock {
+  uint32_t numSamples;  // frames in this request
+  uint32_t eventCount;
+  DartVst3IpcEvent events[kDartVst3IpcMaxEvents];
+};
+
+static_assert(offsetof(DartVst3IpcHeader, slotSets) == 12, "layout is shared with Dart");
+static_assert(offsetof(DartVst3IpcHeader, sampleRate) == 16, "layout is shared with Dart");
+static_assert(offsetof(DartVst3IpcHeader, command) == 24, "layout is shared with Dart");
+static_assert(offsetof(DartVst3IpcHeader, request) == 64, "layout is shared with Dart");
+static_assert(offsetof(DartVst3IpcHeader, response) == 128, "layout is shared with Dart");
+static_assert(sizeof(DartVst3IpcHeader) == 192, "layout is shared with Dart");
+static_assert(offsetof(DartVst3IpcBlock, events) == 8, "layout is shared with Dart");
+static_assert(sizeof(DartVst3IpcBlock) == 6208, "layout is shared with Dart");
+#if defined(__linux__)
+static_assert(sizeof(sem_t) <= 64, "doorbell must fit its header slot");
+#endif
+
+// Host side of the transport. Owns the region and both doorbells; the
+// caller serialises access.
+class DartVst3SharedBlock {
+public:
+  DartVst3SharedBlock() = default;
+  DartVst3SharedBlock(const DartVst3SharedBlock&) = delete;
+  DartVst3SharedBlock& operator=(const DartVst3SharedBlock&) = delete;
+  ~DartVst3SharedBlock() { release(); }
+
+  // Map a region for blocks of up to maxBlock frames with the given
+  // number of slot sets. Returns false and leaves the object empty if
+  // shared memory is unavailable, in which case the caller falls back to
+  // the pipe transport.
+  bool create(uint32_t maxBlock, double sampleRate, uint32_t slotSets = 1) {
+    release();
+    if (maxBlock == 0 || slotSets == 0 || slotSets > kDartVst3IpcMaxSlotSets) return false;
+    stride_ = (maxBlock + kDartVst3IpcSlotAlign - 1) / kDartVst3IpcSlotAlign * kDartVst3IpcSlotAlign;
+    setSize_ = sizeof(DartVst3IpcBlock) + 4 * size_t(stride_) * sizeof(float);
+    size_ = sizeof(DartVst3IpcHeader) + slotSets * setSize_;
+
+#if defined(__linux__)
+    fd_ = int(syscall(SYS_memfd_create, "dart_vst3_ipc", 1u /* MFD_CLOEXEC */));
+    if (fd_ < 0) return false;
+    locator_ = "/proc/" + std::to_string(getpid()) + "/fd/" + std::to_string(fd_);
+#else
+    static std::atomic<unsigned> counter{0};
+    // macOS limits names to 31 characters.
+    char name[32];
+    snprintf(name, sizeof(name), "/dv3.%d.%u", int(getpid()), counter++);
+    name_ = name;
+    fd_ = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd_ < 0) { name_.clear(); return false; }
+    locator_ = name_;
+#endif
+    if (ftruncate(fd_, off_t(size_)) != 0) { release(); return false; }
+    void* p = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) { release(); return false; }
+    base_ = static_cast<unsigned char*>(p);
+    memset(base_, 0, size_);
+
+    auto* h = header();
+    h->magic = kDartVst3IpcMagic;
+    h->version = kDartVst3IpcVersion;
+    h->maxBlock = maxBlock;
+    h->slotSets = slotSets;
+    h->sampleRate = sampleRate;
+    h->command = kDartVst3IpcProcess;
+
+#if defined(__linux__)
+    request_ = reinterpret_cast<sem_t*>(h->request);
+    response_ = reinterpret_cast<sem_t*>(h->response);
+    if (sem_init(request_, 1, 0) != 0 || sem_init(response_, 1, 0) != 0) {
+      request_ = response_ = nullptr;
+      release();
+      return false;
+    }
+    ownsSemaphores_ = true;
+#else
+    request_ = sem_open((name_ + ".q").c_str(), O_CREAT | O_EXCL, 0600, 0);
+    response_ = sem_open((name_ + ".r").c_str(), O_CREAT | O_EXCL, 0600, 0);
+    if (request_ == SEM_FAILED || response_ == SEM_FAILED) {
+      if (request_ == SEM_FAILED) request_ = nullptr;
+      if (response_ == SEM_FAILED) response_ = nullptr;
+      release();
+      return false;
+    }
+#endif
+    return true;
+  }
+
+  bool valid() const { return base_ != nullptr; }
+
+  // Where the Dart executable finds the region: a path to open on Linux,
+  // a shm_open name elsewhere.
+  const std::string& locator() const { return locator_; }
+
+  // Call once the child has mapped the region. Removes the names (and on
+  // Linux the parent's descriptor) so nothing outlives the two processes.
+  void unlink() {
+#if defined(__linux__)
+    if (fd_ >= 0) { close(fd_); fd_ = -1; }
+#else
+    unlinkNames();
+#endif
+  }
+
+  void release() {
+    if (base_) {
+#if defined(__linux__)
+      if (ownsSemaphores_) {
+        sem_destroy(request_);
+        sem_destroy(response_);
+      }
+#endif
+      munmap(base_, size_);
+      base_ = nullptr;
+    }
+#if !defined(__linux__)
+    if (request_) sem_close(request_);
+    if (response_) sem_close(response_);
+    unlinkNames();
+#endif
+    request_ = response_ = nullptr;
+    ownsSemaphores_ = false;
+    if (fd_ >= 0) { close(fd_); fd_ = -1; }
+    locator_.clear();
+    staged_.clear();
+  }
+
+  DartVst3IpcHeader* header() const { return reinterpret_cast<DartVst3IpcHeader*>(base_); }
+  uint32_t maxBlock() const { return header()->maxBlock; }
+  uint32_t slotSets() const { return header()->slotSets; }
+
+  DartVst3IpcBlock* block(uint32_t set) const {
+    return reinterpret_cast<DartVst3IpcBlock*>(base_ + sizeof(DartVst3IpcHeader) + set * setSize_);
+  }
+  float* in(uint32_t set, int channel) const { return slot(set, channel); }
+  float* out(uint32_t set, int channel) const { return slot(set, 2 + channel); }
+
+  // The first set, for unpipelined use.
+  float* inL() const { return in(0, 0); }
+  float* inR() const { return in(0, 1); }
+  float* outL() const { return out(0, 0); }
+  float* outR() const { return out(0, 1); }
+
+  // Events for the blocks still to be submitted, with offsets counted
+  // from the next one. Staged on the host side so they never race a
+  // block Dart is still reading.
+  DartVst3EventQueue& staged() { return staged_; }
+
+  // Stage a parameter change at the start of the next block.
+  void setParameter(int id, double value) {
+    staged_.push({0, kDartVst3EventParameter, id, 0, value});
+  }
+
+  // Hand set to Dart with numSamples frames already in its input slots,
+  // together with the staged events that fall in them. The set must not
+  // be in flight.
+  void submit(uint32_t set, uint32_t numSamples) {
+    auto* b = block(set);
+    b->numSamples = numSamples;
+    b->eventCount = staged_.take(numSamples, b->events, kDartVst3IpcMaxEvents);
+    sem_post(request_);
+  }
+
+  // Take one response if Dart has posted it, without waiting.
+  bool tryCollect() { return sem_trywait(response_) == 0; }
+
+  // Wait for one response. Spins briefly before sleeping since Dart
+  // usually answers within a few microseconds. Returns false on timeout.
+  bool awaitResponse(std::chrono::nanoseconds timeout = std::chrono::milliseconds(2000)) {
+    for (int i = 0; i < kSpin; ++i) {
+      if (sem_trywait(response_) == 0) return true;
+    }
+#if defined(__linux__)
+    timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    auto ns = deadline.tv_nsec + timeout.count();
+    deadline.tv_sec += time_t(ns / 1000000000);
+    deadline.tv_nsec = long(ns % 1000000000);
+    while (sem_timedwait(response_, &deadline) != 0) {
+      if (errno != EINTR) return false;
+    }
+    return true;
+#else
+    // No sem_timedwait here; poll so a dead child cannot wedge the host.
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (sem_trywait(response_) != 0) {
+      if (std::chrono::steady_clock::now() > deadline) return false;
+      std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+    return true;
+#endif
+  }
+
+  // Process numSamples frames already written to the first set and wait
+  // for the result. Returns false if no reply arrives within timeout.
+  bool roundTrip(uint32_t numSamples, std::chrono::nanoseconds timeout = std::chrono::milliseconds(2000)) {
+    submit(0, numSamples);
+    return awaitResponse(timeout);
+  }
+
+  // Ask the worker serving this channel to stop. Its process keeps
+  // running for any other channels. Nothing may be in flight. Returns
+  // false if the worker did not answer.
+  bool detachWorker(std::chrono::nanoseconds timeout = std::chrono::milliseconds(2000)) {
+    header()->command = kDartVst3IpcDetach;
+    sem_post(request_);
+    return awaitResponse(timeout);
+  }
+
+private:
+  static constexpr int kSpin = 2000;
+
+  float* slot(uint32_t set, int i) const {
+    return reinterpret_cast<float*>(block(set) + 1) + size_t(i) * stride_;
+  }
+
+#if !defined(__linux__)
+  void unlinkNames() {
+    if (name_.empty()) return;
+    shm_unlink(name_.c_str());
+    sem_unlink((name_ + ".q").c_str());
+    sem_unlink((name_ + ".r").c_str());
+    name_.clear();
+  }
+  std::string name_;
+#endif
+
+  unsigned char* base_ = nullptr;
+  size_t size_ = 0;
+  size_t setSize_ = 0;
+  uint32_t stride_ = 0;
+  int fd_ = -1;
+  sem_t* request_ = nullptr;
+  sem_t* response_ = nullptr;
+  bool ownsSemaphores_ = false;
+  std::string locator_;
+
+  DartVst3EventQueue staged_;
+};
+
+// Pipelined use of a two-set channel. Input is gathered until it holds
+// maxBlock / sets frames, which keeps at most two blocks in flight
+// whatever the host block size. Output plays back maxBlock plus that
+// threshold after its input: up to a threshold's worth of input can be
+// waiting in the accumulator, and the rest of the latency always covers
+// the next host call, so the output never runs dry however the block
+// size varies. Each block submitted to the free set has until the host
+// call that needs it to come back, a whole block period when the host
+// sends full blocks. The host thread never waits on Dart. A block Dart
+// has not finished when its output is due plays dry, delayed like the
+// processed signal, and its late reply is discarded; a block arriving
+// while both sets are still busy is dropped and plays dry too.
+class DartVst3Pipeline {
+public:
+  // Size the host-side buffers for shm. Call off the audio thread.
+  void prepare(DartVst3SharedBlock& shm) {
+    shm_ = &shm;
+    period_ = shm.maxBlock();
+    sets_ = shm.slotSets();
+    threshold_ = (period_ + sets_ - 1) / sets_;
+    for (int c = 0; c < 2; ++c) {
+      acc_[c].assign(period_, 0.0f);
+      fifo_[c].assign(2 * size_t(period_), 0.0f);
+      for (auto& dry : dry_) dry[c].assign(period_, 0.0f);
+    }
+    accCount_ = 0;
+    fifoRead_ = 0;
+    fifoCount_ = latency();  // primed with silence
+    pipeHead_ = pipeCount_ = 0;
+    outHead_ = outCount_ = 0;
+    submitted_ = 0;
+    consecutiveMisses_ = 0;
+    std::fill(std::begin(busy_), std::end(busy_), false);
+  }
+
+  // Move to a fresh channel with the same shape, for instance after the
+  // worker behind the old one stopped answering. Blocks still out with
+  // the old worker play dry; nothing already gathered or played is lost.
+  // Call with the old channel still mapped.
+  void rebind(DartVst3SharedBlock& shm) {
+    for (uint32_t i = 0; i < pipeCount_; ++i) {
+      const uint32_t index = (pipeHead_ + i) % kPipeCapacity;
+      Pending& p = pipe_[index];
+      if (p.set < 0) continue;
+      for (int c = 0; c < 2; ++c) {
+        memcpy(dry_[index][c].data(), shm_->in(uint32_t(p.set), c), p.frames * sizeof(float));
+      }
+      p.set = -1;
+    }
+    shm_ = &shm;
+    outHead_ = outCount_ = 0;
+    submitted_ = 0;
+    consecutiveMisses_ = 0;
+    std::fill(std::begin(busy_), std::end(busy_), false);
+  }
+
+  // Added latency in frames.
+  uint32_t latency() const { return period_ + threshold_; }
+
+  uint64_t lateBlocks() const { return late_; }
+  uint64_t droppedBlocks() const { return dropped_; }
+  uint64_t misses() const { return late_ + dropped_; }
+
+  // Blocks played dry since the last one Dart returned in time.
+  uint32_t consecutiveMisses() const { return consecutiveMisses_; }
+
+  // events holds this call's events, offsets counted from inL[0]. They
+  // are staged behind the input still being gathered.
+  void process(const float* inL, const float* inR, float* outL, float* outR, int numSamples,
+               DartVst3EventQueue& events) {
+    shm_->staged().append(events, accCount_);
+    for (int done = 0; done < numSamples; ) {
+      const int n = std::min(numSamples - done, int(period_));
+      step(inL + done, inR + done, outL + done, outR + done, n);
+      done += n;
+    }
+  }
+
+  // Wait for blocks still in flight so the channel can be detached.
+  bool finish(std::chrono::nanoseconds timeout = std::chrono::milliseconds(2000)) {
+    while (outCount_ > 0) {
+      if (!shm_->awaitResponse(timeout)) return false;
+      busy_[outstanding_[outHead_].set] = false;
+      outHead_ = (outHead_ + 1) % kDartVst3IpcMaxSlotSets;
+      --outCount_;
+    }
+    pipeCount_ = 0;
+    return true;
+  }
+
+private:
+  static constexpr uint32_t kPipeCapacity = 4;
+
+  // A block whose output has not reached the FIFO. set < 0 was dropped.
+  struct Pending { int set; uint32_t frames; bool ready; };
+  // A submitted block whose reply has not been collected.
+  struct Outstanding { int set; bool abandoned; };
+
+  void step(const float* inL, const float* inR, float* outL, float* outR, int n) {
+    // Take what this call plays first, freeing its set for the submit.
+    reap();
+    while (fifoCount_ < uint32_t(n) && pipeCount_ > 0) drainFront();
+
+    // A block never outgrows a slot. Flushing early only happens when the
+    // host block size jumps, and may cost that one block.
+    if (accCount_ + uint32_t(n) > period_) submitBlock();
+    memcpy(acc_[0].data() + accCount_, inL, n * sizeof(float));
+    memcpy(acc_[1].data() + accCount_, inR, n * sizeof(float));
+    accCount_ += uint32_t(n);
+    if (accCount_ >= threshold_) submitBlock();
+
+    const uint32_t cap = uint32_t(fifo_[0].size());
+    for (int i = 0; i < n; ++i) {
+      if (fifoCount_ == 0) {
+        outL[i] = outR[i] = 0.0f;
+        continue;
+      }
+      outL[i] = fifo_[0][fifoRead_];
+      outR[i] = fifo_[1][fifoRead_];
+      fifoRead_ = (fifoRead_ + 1) % cap;
+      --fifoCount_;
+    }
+  }
+
+  void submitBlock() {
+    const uint32_t frames = accCount_;
+    if (frames == 0) return;
+    accCount_ = 0;
+    reap();
+    // Gathered, pending and queued output always add up to the latency,
+    // so there is room in the FIFO for the oldest block.
+    if (pipeCount_ == kPipeCapacity) drainFront();
+    const int set = int(submitted_ % sets_);
+    if (busy_[set]) {
+      shm_->staged().skip(frames);
+      // Keep the input to play dry in its place
+      const uint32_t index = (pipeHead_ + pipeCount_) % kPipeCapacity;
+      memcpy(dry_[index][0].data(), acc_[0].data(), frames * sizeof(float));
+      memcpy(dry_[index][1].data(), acc_[1].data(), frames * sizeof(float));
+      pushPending({-1, frames, false});
+      ++dropped_;
+      return;
+    }
+    memcpy(shm_->in(set, 0), acc_[0].data(), frames * sizeof(float));
+    memcpy(shm_->in(set, 1), acc_[1].data(), frames * sizeof(float));
+    shm_->submit(uint32_t(set), frames);
+    busy_[set] = true;
+    ++submitted_;
+    outstanding_[(outHead_ + outCount_) % kDartVst3IpcMaxSlotSets] = {set, false};
+    ++outCount_;
+    pushPending({set, frames, false});
+  }
+
+  // Collect every reply Dart has posted. Replies arrive in submit order.
+  void reap() {
+    while (outCount_ > 0 && shm_->tryCollect()) {
+      const Outstanding o = outstanding_[outHead_];
+      outHead_ = (outHead_ + 1) % kDartVst3IpcMaxSlotSets;
+      --outCount_;
+      if (o.abandoned) {
+        busy_[o.set] = false;
+        continue;
+      }
+      for (uint32_t i = 0; i < pipeCount_; ++i) {
+        Pending& p = pipe_[(pipeHead_ + i) % kPipeCapacity];
+        if (p.set == o.set && !p.ready) {
+          p.ready = true;
+          break;
+        }
+      }
+    }
+  }
+
+  // Move the oldest pending block into the FIFO, dry if it is not back
+  // yet.
+  void drainFront() {
+    const uint32_t index = pipeHead_;
+    const Pending p = pipe_[index];
+    pipeHead_ = (pipeHead_ + 1) % kPipeCapacity;
+    --pipeCount_;
+
+    const float* srcL;
+    const float* srcR;
+    if (p.set >= 0 && p.ready) {
+      srcL = shm_->out(uint32_t(p.set), 0);
+      srcR = shm_->out(uint32_t(p.set), 1);
+      consecutiveMisses_ = 0;
+    } else if (p.set >= 0) {
+      // Dart only reads the inputs, so they are intact until the set is
+      // reused, which waits for its late reply
+      srcL = shm_->in(uint32_t(p.set), 0);
+      srcR = shm_->in(uint32_t(p.set), 1);
+      for (uint32_t i = 0; i < outCount_; ++i) {
+        Outstanding& o = outstanding_[(outHead_ + i) % kDartVst3IpcMaxSlotSets];
+        if (o.set == p.set) o.abandoned = true;
+      }
+      ++late_;
+      ++consecutiveMisses_;
+    } else {
+      srcL = dry_[index][0].data();
+      srcR = dry_[index][1].data();
+      ++consecutiveMisses_;
+    }
+
+    const uint32_t cap = uint32_t(fifo_[0].size());
+    uint32_t write = (fifoRead_ + fifoCount_) % cap;
+    for (uint32_t i = 0; i < p.frames; ++i) {
+      fifo_[0][write] = srcL[i];
+      fifo_[1][write] = srcR[i];
+      write = (write + 1) % cap;
+    }
+    fifoCount_ += p.frames;
+    if (p.set >= 0 && p.ready) busy_[p.set] = false;
+  }
+
+  void pushPending(Pending p) {
+    pipe_[(pipeHead_ + pipeCount_) % kPipeCapacity] = p;
+    ++pipeCount_;
+  }
+
+  DartVst3SharedBlock* shm_ = nullptr;
+  uint32_t period_ = 0;
+  uint32_t sets_ = 1;
+  uint32_t threshold_ = 0;
+  std::vector<float> acc_[2];
+  uint32_t accCount_ = 0;
+  std::vector<float> fifo_[2];
+  uint32_t fifoRead_ = 0;
+  uint32_t fifoCount_ = 0;
+  Pending pipe_[kPipeCapacity] = {};
+  std::vector<float> dry_[kPipeCapacity][2];
+  uint32_t pipeHead_ = 0;
+  uint32_t pipeCount_ = 0;
+  Outstanding outstanding_[kDartVst3IpcMaxSlotSets] = {};
+  uint32_t outHead_ = 0;
+  uint32_t outCount_ = 0;
+  uint64_t submitted_ = 0;
+  bool busy_[kDartVst3IpcMaxSlotSets] = {};
+  uint64_t late_ = 0;
+  uint64_t dropped_ = 0;
+  uint32_t consecutiveMisses_ = 0;
+};
+
+#endif  // _WIN32
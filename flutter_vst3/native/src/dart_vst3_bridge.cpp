@@ -12,16 +12,87 @@
 #include <stdexcept>
 #include <cstdio>
 #include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
 
-// Per-instance data structure
+// Parameter ids below this are mirrored in the instance's snapshot
+static constexpr int32_t kMaxSnapshotParameters = DART_VST3_MAX_SNAPSHOT_PARAMETERS;
+
+static_assert(std::atomic<double>::is_always_lock_free,
+              "parameter snapshot must be lock-free");
+
+// Per-instance data structure. The callback table is published once per
+// registration and never modified afterwards, so the audio thread reads it
+// with a single atomic load and never waits on a registration.
 struct DartVST3Instance {
     std::string plugin_id;
-    DartVST3Callbacks callbacks;
-    bool callbacks_registered;
-    std::mutex mutex;
+    std::atomic<const DartVST3Callbacks*> callbacks;
+    std::atomic<uint64_t> bypassed_blocks;
+    std::atomic<double> parameters[kMaxSnapshotParameters];
+
+    // Serialises registrations and owns every table published, so a reader
+    // holding an old table stays valid until the instance is destroyed
+    std::mutex publish_mutex;
+    std::vector<std::unique_ptr<DartVST3Callbacks>> tables;
+
+    // Planar audio slots, carved out of slot_storage on
+    // DART_VST3_SLOT_ALIGNMENT boundaries
+    std::unique_ptr<float[]> slot_storage;
+    DartVST3AudioSlots slots;
     
     DartVST3Instance(const std::string& id) 
-        : plugin_id(id), callbacks{0}, callbacks_registered(false) {}
+        : plugin_id(id), callbacks(nullptr), bypassed_blocks(0), slots{} {
+        clearSnapshot();
+    }
+
+    // Grow the slots to hold frames per plane. Only called from
+    // dart_vst3_initialize, never while audio is running.
+    void reserveSlots(int32_t frames) {
+        constexpr int32_t kAlignFloats = DART_VST3_SLOT_ALIGNMENT / sizeof(float);
+        if (frames <= slots.capacity) return;
+        const int32_t capacity = (frames + kAlignFloats - 1) / kAlignFloats * kAlignFloats;
+        slot_storage.reset(new float[4 * size_t(capacity) + kAlignFloats]());
+        auto address = reinterpret_cast<uintptr_t>(slot_storage.get());
+        auto* base = reinterpret_cast<float*>(
+            (address + DART_VST3_SLOT_ALIGNMENT - 1) & ~uintptr_t(DART_VST3_SLOT_ALIGNMENT - 1));
+        slots.input_l = base;
+        slots.input_r = base + capacity;
+        slots.output_l = base + 2 * size_t(capacity);
+        slots.output_r = base + 3 * size_t(capacity);
+        slots.capacity = capacity;
+    }
+
+    // NaN marks a parameter the processor does not have
+    void clearSnapshot() {
+        for (auto& value : parameters) {
+            value.store(std::numeric_limits<double>::quiet_NaN(), std::memory_order_relaxed);
+        }
+    }
+
+    // Read every snapshotted parameter from the processor so getters
+    // never have to ask Dart. Called when the processor is registered,
+    // initialized and reset, on the thread doing so.
+    void fillSnapshot(const DartVST3Callbacks* callbacks) {
+        clearSnapshot();
+        if (!callbacks->get_parameter || !callbacks->get_parameter_count) return;
+        const int32_t count = std::min(callbacks->get_parameter_count(), kMaxSnapshotParameters);
+        for (int32_t id = 0; id < count; id++) {
+            parameters[id].store(callbacks->get_parameter(id), std::memory_order_relaxed);
+        }
+    }
+
+    const DartVST3Callbacks* table() const {
+        return callbacks.load(std::memory_order_acquire);
+    }
+
+    std::atomic<double>* snapshot(int32_t param_id) {
+        if (param_id < 0 || param_id >= kMaxSnapshotParameters) return nullptr;
+        return &parameters[param_id];
+    }
 };
 
 // Global instance registry
@@ -60,11 +131,12 @@ int32_t dart_vst3_register_callbacks(DartVST3Instance* instance,
                                      const DartVST3Callbacks* callbacks) {
     if (!instance || !callbacks) return 0;
     
-    std::lock_guard<std::mutex> lock(instance->mutex);
-    
-    // Copy all callback function pointers
-    instance->callbacks = *callbacks;
-    instance->callbacks_registered = true;
+    // Copy all callback function pointers into a fresh table and publish it
+    auto table = std::make_unique<DartVST3Callbacks>(*callbacks);
+    std::lock_guard<std::mutex> lock(instance->publish_mutex);
+    instance->fillSnapshot(table.get());
+    instance->callbacks.store(table.get(), std::memory_order_release);
+    instance->tables.push_back(std::move(table));
     
     return 1;
 }
@@ -73,13 +145,14 @@ int32_t dart_vst3_initialize(DartVST3Instance* instance,
                             double sample_rate, int32_t max_block_size) {
     if (!instance) return 0;
     
-    std::lock_guard<std::mutex> lock(instance->mutex);
-    
-    if (!instance->callbacks_registered || !instance->callbacks.initialize_processor) {
+    const DartVST3Callbacks* callbacks = instance->table();
+    if (!callbacks || !callbacks->initialize_processor) {
         return 0;
     }
     
-    instance->callbacks.initialize_processor(sample_rate, max_block_size);
+    instance->reserveSlots(max_block_size > 0 ? max_block_size : 512);
+    callbacks->initialize_processor(sample_rate, max_block_size);
+    instance->fillSnapshot(callbacks);
     return 1;
 }
 
@@ -89,82 +162,159 @@ int32_t dart_vst3_process_stereo(DartVST3Instance* instance,
                                 int32_t num_samples) {
     if (!instance) return 0;
     
-    std::lock_guard<std::mutex> lock(instance->mutex);
+    const DartVST3Callbacks* callbacks = instance->table();
+    // Separate host buffers go to Dart as they are. In-place buffers go
+    // through the slots instead, so Dart never has to copy an input that
+    // its output would overwrite.
+    const bool inPlace = input_l == output_l || input_r == output_r;
+    const bool slotted = callbacks && callbacks->process_slots && instance->slots.capacity > 0 &&
+                         (inPlace || !callbacks->process_audio);
+    if (!slotted && (!callbacks || !callbacks->process_audio)) {
+        // No Dart processor yet: pass the input through and count it
+        // rather than taking the host down
+        if (instance->bypassed_blocks++ == 0) {
+            fprintf(stderr, "VST3 BRIDGE: No Dart callbacks registered, bypassing! Plugin ID: %s\n", instance->plugin_id.c_str());
+            fflush(stderr);
+        }
+        if (num_samples > 0) {
+            if (output_l != input_l) memmove(output_l, input_l, num_samples * sizeof(float));
+            if (output_r != input_r) memmove(output_r, input_r, num_samples * sizeof(float));
+        }
+        return 0;
+    }
+    
+    if (!slotted) {
+        callbacks->process_audio(input_l, input_r, output_l, output_r, num_samples);
+        return 1;
+    }
+    
+    // Copy through the slots, a slot's capacity at a time. The planes never
+    // alias, so the in-place host buffer is safe.
+    DartVST3AudioSlots& slots = instance->slots;
+    for (int32_t done = 0; done < num_samples; ) {
+        const int32_t n = std::min(num_samples - done, slots.capacity);
+        memcpy(slots.input_l, input_l + done, n * sizeof(float));
+        memcpy(slots.input_r, input_r + done, n * sizeof(float));
+        callbacks->process_slots(&slots, n);
+        memcpy(output_l + done, slots.output_l, n * sizeof(float));
+        memcpy(output_r + done, slots.output_r, n * sizeof(float));
+        done += n;
+    }
+    return 1;
+}
+
+const DartVST3AudioSlots* dart_vst3_get_audio_slots(DartVST3Instance* instance) {
+    if (!instance || instance->slots.capacity == 0) return nullptr;
+    return &instance->slots;
+}
+
+int32_t dart_vst3_process_slots(DartVST3Instance* instance, int32_t num_samples) {
+    if (!instance) return 0;
     
-    if (!instance->callbacks_registered || !instance->callbacks.process_audio) {
-        // NO FALLBACKS! FAIL HARD! CRASH THE ENTIRE PLUGIN!
-        fprintf(stderr, "CRITICAL VST3 BRIDGE FAILURE: No Dart callbacks registered! Plugin ID: %s\n", instance->plugin_id.c_str());
-        fprintf(stderr, "CALLBACKS_REGISTERED: %d\n", instance->callbacks_registered);
-        fprintf(stderr, "PROCESS_AUDIO CALLBACK: %p\n", (void*)instance->callbacks.process_audio);
-        fflush(stderr);
-        abort(); // KILL THE PLUGIN HARD!
+    const DartVST3Callbacks* callbacks = instance->table();
+    if (!callbacks || !callbacks->process_slots ||
+        num_samples < 0 || num_samples > instance->slots.capacity) {
+        return 0;
     }
     
-    instance->callbacks.process_audio(input_l, input_r, output_l, output_r, num_samples);
+    callbacks->process_slots(&instance->slots, num_samples);
     return 1;
 }
 
+uint64_t dart_vst3_get_bypassed_blocks(DartVST3Instance* instance) {
+    return instance ? instance->bypassed_blocks.load() : 0;
+}
+
 int32_t dart_vst3_set_parameter(DartVST3Instance* instance,
                                 int32_t param_id, double normalized_value) {
     if (!instance) return 0;
     
-    std::lock_guard<std::mutex> lock(instance->mutex);
+    const DartVST3Callbacks* callbacks = instance->table();
+    if (!callbacks || !callbacks->set_parameter) {
+        return 0;
+    }
+    
+    if (auto* slot = instance->snapshot(param_id)) {
+        slot->store(normalized_value, std::memory_order_relaxed);
+    }
+    callbacks->set_parameter(param_id, normalized_value);
+    return 1;
+}
+
+int32_t dart_vst3_set_parameters_batch(DartVST3Instance* instance,
+                                       const int32_t* param_ids,
+                                       const double* normalized_values,
+                                       int32_t count) {
+    if (!instance || count < 0 || (count > 0 && (!param_ids || !normalized_values))) return 0;
     
-    if (!instance->callbacks_registered || !instance->callbacks.set_parameter) {
+    const DartVST3Callbacks* callbacks = instance->table();
+    if (!callbacks || (!callbacks->set_parameters_batch && !callbacks->set_parameter)) {
         return 0;
     }
+    if (count == 0) return 1;
+    
+    for (int32_t i = 0; i < count; i++) {
+        if (auto* slot = instance->snapshot(param_ids[i])) {
+            slot->store(normalized_values[i], std::memory_order_relaxed);
+        }
+    }
     
-    instance->callbacks.set_parameter(param_id, normalized_value);
+    // Processors registered without a batch callback still get every value
+    if (callbacks->set_parameters_batch) {
+        callbacks->set_parameters_batch(param_ids, normalized_values, count);
+    } else {
+        for (int32_t i = 0; i < count; i++) {
+            callbacks->set_parameter(param_ids[i], normalized_values[i]);
+        }
+    }
     return 1;
 }
 
 double dart_vst3_get_parameter(DartVST3Instance* instance, int32_t param_id) {
     if (!instance) return 0.0;
     
-    std::lock_guard<std::mutex> lock(instance->mutex);
-    
-    if (!instance->callbacks_registered || !instance->callbacks.get_parameter) {
-        return 0.0;
-    }
+    // Answered from the snapshot alone, so a getter never enters Dart
+    auto* slot = instance->snapshot(param_id);
+    if (!slot) return 0.0;
     
-    return instance->callbacks.get_parameter(param_id);
+    double value = slot->load(std::memory_order_relaxed);
+    return value == value ? value : 0.0;
 }
 
 int32_t dart_vst3_get_parameter_count(DartVST3Instance* instance) {
     if (!instance) return 0;
     
-    std::lock_guard<std::mutex> lock(instance->mutex);
-    
-    if (!instance->callbacks_registered || !instance->callbacks.get_parameter_count) {
+    const DartVST3Callbacks* callbacks = instance->table();
+    if (!callbacks || !callbacks->get_parameter_count) {
         return 0;
     }
     
-    return instance->callbacks.get_parameter_count();
+    return callbacks->get_parameter_count();
 }
 
 int32_t dart_vst3_reset(DartVST3Instance* instance) {
     if (!instance) return 0;
     
-    std::lock_guard<std::mutex> lock(instance->mutex);
-    
-    if (!instance->callbacks_registered || !instance->callbacks.reset) {
+    const DartVST3Callbacks* callbacks = instance->table();
+    if (!callbacks || !callbacks->reset) {
         return 0;
     }
     
-    instance->callbacks.reset();
+    callbacks->reset();
+    instance->fillSnapshot(callbacks);
     return 1;
 }
 
 int32_t dart_vst3_dispose(DartVST3Instance* instance) {
     if (!instance) return 0;
     
-    std::lock_guard<std::mutex> lock(instance->mutex);
-    
-    if (!instance->callbacks_registered || !instance->callbacks.dispose) {
+    const DartVST3Callbacks* callbacks = instance->table();
+    if (!callbacks || !callbacks->dispose) {
         return 0;
     }
     
-    instance->callbacks.dispose();
+    callbacks->dispose();
+    instance->clearSnapshot();
     return 1;
 }
 
@@ -87,33 +87,31 @@ public:
     if (!graph_) return kResultFalse;
 
     // Apply parameter changes from automation. Only one parameter for
-    // gain is implemented. Iterate through all incoming changes and
-    // update the graph accordingly.
+    // gain is implemented. Every point of each queue is forwarded with
+    // its sample offset so automation stays sample accurate at any
+    // block size.
     if (data.inputParameterChanges) {
       int32 listCount = data.inputParameterChanges->getParameterCount();
       for (int32 i = 0; i < listCount; ++i) {
         IParamValueQueue* q = data.inputParameterChanges->getParameterData(i);
-        if (!q) continue;
-        int32 index;
-        ParamValue v;
-        int32 sampleOffset;
-        // Use the last point in the queue as the effective value
-        if (q->getPoint(q->getPointCount() - 1, sampleOffset, v) == kResultTrue) {
-          if (q->getParameterId() == kParamOutputGain) {
-            dvh_graph_set_param(graph_, gainNode_, 0, (float)v);
-          }
+        if (!q || q->getParameterId() != kParamOutputGain) continue;
+        for (int32 k = 0; k < q->getPointCount(); ++k) {
+          ParamValue v;
+          int32 sampleOffset;
+          if (q->getPoint(k, sampleOffset, v) != kResultTrue) continue;
+          dvh_graph_set_param_at(graph_, gainNode_, 0, sampleOffset, (float)v);
         }
       }
     }
 
-    // Dispatch MIDI events
+    // Dispatch MIDI events at their offsets within the block
     if (data.inputEvents) {
       int32 n = data.inputEvents->getEventCount();
       for (int32 i = 0; i < n; ++i) {
         Event e;
         if (data.inputEvents->getEvent(i, e) != kResultTrue) continue;
-        if (e.type == Event::kNoteOnEvent) dvh_graph_note_on(graph_, -1, e.noteOn.channel, e.noteOn.pitch, e.noteOn.velocity);
-        if (e.type == Event::kNoteOffEvent) dvh_graph_note_off(graph_, -1, e.noteOff.channel, e.noteOff.pitch, e.noteOff.velocity);
+        if (e.type == Event::kNoteOnEvent) dvh_graph_note_on_at(graph_, -1, e.sampleOffset, e.noteOn.channel, e.noteOn.pitch, e.noteOn.velocity);
+        if (e.type == Event::kNoteOffEvent) dvh_graph_note_off_at(graph_, -1, e.sampleOffset, e.noteOff.channel, e.noteOff.pitch, e.noteOff.velocity);
       }
     }
 
@@ -137,12 +135,9 @@ public:
       }
     }
     if (!outL || !outR) return kResultFalse;
-    // Provide zero input if no buffers are connected (e.g. instrument)
-    if (!inL || !inR) {
-      static float zeros[4096] = {0};
-      inL = inR = zeros;
-    }
 
+    // The graph renders silence for missing inputs (e.g. instrument)
+    // and splits blocks larger than its maximum block size.
     if (dvh_graph_process_stereo(graph_, inL, inR, outL, outR, data.numSamples) != 1)
       return kResultFalse;
 
@@ -0,0 +1,217 @@
+// Checks the native processor's deadline handling: a worker that stops
+// answering plays dry and counts as missed, is restarted in the
+// background, and the fresh worker gets the queued parameters again, so
+// audio comes back processed.
+//
+// The processor is the real template, expanded as generate_plugin.dart
+// does. It starts its worker as <its directory>/deadline_test_processor,
+// so the test binary carries that name and also stands in for the Dart
+// executable when it is started as one.
+//
+// Build and run from this directory:
+//
+//   sed 's/{{PLUGIN_CLASS_NAME}}/DeadlineTest/g; s/{{PLUGIN_ID}}/deadline_test/g; s/{{PLUGIN_NAME_UPPER}}/DEADLINE TEST/g' ../templates/plugin_processor_native.cpp.template > deadline_test_native.inc
+//   c++ -std=c++17 -O2 -pthread -I../include -I. deadline_test.cpp -o deadline_test_processor -ldl
+//   ./deadline_test_processor
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "deadline_test_native.inc"
+
+namespace {
+
+// Set in the environment of the worker processes the test starts
+constexpr const char* kWorkerVar = "DEADLINE_TEST_WORKER";
+// Blocks a worker serves before it stops answering; unset means never
+constexpr const char* kStallVar = "DEADLINE_TEST_STALL_AFTER";
+
+constexpr int kBlock = 512;
+constexpr double kSampleRate = 48000.0;
+constexpr int kStallAfter = 16;
+constexpr double kDefaultGain = 0.25; // a fresh worker's parameter 0
+constexpr double kGain = 0.5;         // the value the host queues
+
+// Serves one attached channel as serveSharedAudio and processBlock in
+// flutter_vst3_ipc.dart do, with a gain processor whose parameter 0 is
+// the gain. Stops answering for good after stallAfter blocks, if set.
+void serveChannel(unsigned char* base, sem_t* request, sem_t* response, long stallAfter) {
+  auto* header = reinterpret_cast<DartVst3IpcHeader*>(base);
+  const uint32_t stride =
+      (header->maxBlock + kDartVst3IpcSlotAlign - 1) / kDartVst3IpcSlotAlign * kDartVst3IpcSlotAlign;
+  const size_t setSize = sizeof(DartVst3IpcBlock) + 4 * size_t(stride) * sizeof(float);
+  double gain = kDefaultGain;
+  for (long served = 0;; ++served) {
+    while (sem_wait(request) != 0) {}
+    if (header->command == kDartVst3IpcDetach) break;
+    while (served == stallAfter) pause();
+
+    unsigned char* set = base + sizeof(DartVst3IpcHeader) + size_t(served % header->slotSets) * setSize;
+    auto* block = reinterpret_cast<DartVst3IpcBlock*>(set);
+    auto* slots = reinterpret_cast<float*>(block + 1);
+    const uint32_t frames = block->numSamples;
+    uint32_t start = 0;
+    auto render = [&](uint32_t end) {
+      for (uint32_t i = start; i < end; ++i) {
+        slots[2 * stride + i] = float(slots[i] * gain);
+        slots[3 * stride + i] = float(slots[stride + i] * gain);
+      }
+      start = end;
+    };
+    for (uint32_t e = 0; e < block->eventCount; ++e) {
+      const DartVst3IpcEvent& event = block->events[e];
+      render(std::max(start, std::min(event.sampleOffset, frames)));
+      if (event.kind == kDartVst3EventParameter && event.id == 0) gain = event.value;
+    }
+    render(frames);
+    sem_post(response);
+  }
+  sem_post(response);
+}
+
+// Answers the control messages of the stdio protocol and serves every
+// attached channel on its own thread.
+int worker(bool shared) {
+  if (!shared) return 1; // the test needs shared memory
+  const char* stall = getenv(kStallVar);
+  const long stallAfter = stall ? atol(stall) : -1;
+
+  uint8_t command;
+  while (fread(&command, 1, 1, stdin) == 1) {
+    if (command == CMD_INIT) {
+      double sampleRate;
+      if (fread(&sampleRate, sizeof(sampleRate), 1, stdin) != 1) return 1;
+    } else if (command == CMD_ATTACH) {
+      uint32_t length;
+      if (fread(&length, sizeof(length), 1, stdin) != 1) return 1;
+      std::string locator(length, '\0');
+      if (fread(&locator[0], 1, length, stdin) != length) return 1;
+#if defined(__linux__)
+      const int fd = open(locator.c_str(), O_RDWR);
+#else
+      const int fd = shm_open(locator.c_str(), O_RDWR);
+#endif
+      struct stat st;
+      if (fd < 0 || fstat(fd, &st) != 0) return 1;
+      void* mapped = mmap(nullptr, size_t(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      close(fd);
+      if (mapped == MAP_FAILED) return 1;
+      auto* base = static_cast<unsigned char*>(mapped);
+      auto* header = reinterpret_cast<DartVst3IpcHeader*>(base);
+#if defined(__linux__)
+      sem_t* request = reinterpret_cast<sem_t*>(header->request);
+      sem_t* response = reinterpret_cast<sem_t*>(header->response);
+#else
+      sem_t* request = sem_open((locator + ".q").c_str(), 0);
+      sem_t* response = sem_open((locator + ".r").c_str(), 0);
+#endif
+      std::thread(serveChannel, base, request, response, stallAfter).detach();
+    } else if (command == CMD_TERMINATE) {
+      break;
+    } else {
+      return 1;
+    }
+    fwrite(&command, 1, 1, stdout); // ACK
+    fflush(stdout);
+  }
+  _exit(0); // a stalled channel thread never returns
+}
+
+enum class Heard { kWet, kDry, kDefault, kOther };
+
+const char* describe(Heard heard) {
+  switch (heard) {
+    case Heard::kWet: return "processed";
+    case Heard::kDry: return "dry";
+    case Heard::kDefault: return "processed without the queued parameter";
+    default: return "garbled";
+  }
+}
+
+// Plays one block of a ramp through the processor and says what came out.
+Heard play(void* processor, uint64_t& frame) {
+  std::vector<float> inL(kBlock), inR(kBlock), outL(kBlock), outR(kBlock);
+  for (int i = 0; i < kBlock; ++i) {
+    inL[i] = float((frame + i) % 1000 + 1);
+    inR[i] = -inL[i];
+  }
+  frame += kBlock;
+  deadline_test_native_process_stereo(processor, inL.data(), inR.data(), outL.data(), outR.data(), kBlock);
+
+  auto scaledBy = [&](double gain) {
+    for (int i = 0; i < kBlock; ++i) {
+      if (outL[i] != float(inL[i] * gain) || outR[i] != float(inR[i] * gain)) return false;
+    }
+    return true;
+  };
+  if (scaledBy(kGain)) return Heard::kWet;
+  if (scaledBy(1.0)) return Heard::kDry;
+  if (scaledBy(kDefaultGain)) return Heard::kDefault;
+  return Heard::kOther;
+}
+
+int check(bool ok, const char* what) {
+  printf("%-52s %s\n", what, ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (getenv(kWorkerVar)) return worker(argc > 1 && strcmp(argv[1], "--shared-audio") == 0);
+  setenv(kWorkerVar, "1", 1);
+
+  // Only the first worker stalls; the one the restart brings up does not
+  setenv(kStallVar, std::to_string(kStallAfter).c_str(), 1);
+  void* processor = deadline_test_native_create();
+  deadline_test_native_initialize(processor, kSampleRate, kBlock);
+  unsetenv(kStallVar);
+  deadline_test_native_queue_parameter(processor, 0, kGain, 0);
+
+  int failures = 0;
+  uint64_t frame = 0;
+  bool wet = true;
+  for (int b = 0; b < kStallAfter; ++b) wet = play(processor, frame) == Heard::kWet && wet;
+  failures += check(wet, "blocks before the stall are processed");
+
+  // The stalled block waits out its budget, then plays dry
+  failures += check(play(processor, frame) == Heard::kDry, "the stalled block plays dry");
+  failures += check(deadline_test_native_get_deadline_misses(processor) == 1, "and counts as a miss");
+
+  // Keep playing until the worker is back, as a host would
+  uint64_t dry = 1;
+  Heard heard = Heard::kDry;
+  const auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (std::chrono::steady_clock::now() < giveUp) {
+    heard = play(processor, frame);
+    if (heard != Heard::kDry) break;
+    ++dry;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  printf("%llu dry blocks, then %s\n", static_cast<unsigned long long>(dry), describe(heard));
+  failures += check(deadline_test_native_get_restarts(processor) == 1, "the worker is restarted");
+  failures += check(deadline_test_native_get_deadline_misses(processor) == dry, "every dry block counts as a miss");
+  failures += check(heard == Heard::kWet, "the queued parameter reaches the new worker");
+
+  wet = true;
+  for (int b = 0; b < kStallAfter; ++b) wet = play(processor, frame) == Heard::kWet && wet;
+  failures += check(wet, "later blocks are processed");
+  failures += check(deadline_test_native_get_deadline_misses(processor) == dry, "and miss nothing");
+
+  deadline_test_native_dispose(processor);
+
+  if (failures != 0) {
+    fprintf(stderr, "FAILED\n");
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
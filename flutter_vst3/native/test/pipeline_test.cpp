@@ -0,0 +1,121 @@
+// Checks that DartVst3Pipeline plays its input back exactly latency()
+// frames later whatever block sizes the host sends, with a worker thread
+// standing in for the Dart executable.
+//
+// Build and run from this directory:
+//
+//   c++ -std=c++17 -O2 -pthread -I../include pipeline_test.cpp -o pipeline_test
+//   ./pipeline_test
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "dart_vst3_ipc.h"
+
+namespace {
+
+constexpr uint32_t kMaxBlock = 512;
+constexpr float kGain = 0.5f;
+
+// Serves the channel as the Dart side does: sets in request order, each
+// scaled by kGain, until asked to detach.
+void serve(DartVst3SharedBlock& shm) {
+#if defined(__linux__)
+  sem_t* request = reinterpret_cast<sem_t*>(shm.header()->request);
+  sem_t* response = reinterpret_cast<sem_t*>(shm.header()->response);
+#else
+  sem_t* request = sem_open((shm.locator() + ".q").c_str(), 0);
+  sem_t* response = sem_open((shm.locator() + ".r").c_str(), 0);
+#endif
+  for (uint32_t next = 0;; ++next) {
+    while (sem_wait(request) != 0) {}
+    if (shm.header()->command == kDartVst3IpcDetach) break;
+    const uint32_t set = next % shm.slotSets();
+    const uint32_t frames = shm.block(set)->numSamples;
+    for (int c = 0; c < 2; ++c) {
+      for (uint32_t i = 0; i < frames; ++i) shm.out(set, c)[i] = shm.in(set, c)[i] * kGain;
+    }
+    sem_post(response);
+  }
+  sem_post(response);
+#if !defined(__linux__)
+  sem_close(request);
+  sem_close(response);
+#endif
+}
+
+// Runs the host side over sizes and compares the output with the input
+// delayed by the reported latency. Returns the number of wrong frames.
+int run(const char* name, const std::vector<int>& sizes) {
+  DartVst3SharedBlock shm;
+  if (!shm.create(kMaxBlock, 48000.0, 2)) {
+    fprintf(stderr, "%s: shared memory unavailable\n", name);
+    return 1;
+  }
+  std::thread worker(serve, std::ref(shm));
+  DartVst3Pipeline pipeline;
+  pipeline.prepare(shm);
+  DartVst3EventQueue events;
+
+  size_t total = 0;
+  for (int n : sizes) total += size_t(n);
+  std::vector<float> inL(total), inR(total), outL(total), outR(total);
+  for (size_t i = 0; i < total; ++i) {
+    inL[i] = float(i % 1000 + 1);
+    inR[i] = -inL[i];
+  }
+
+  size_t pos = 0;
+  for (int n : sizes) {
+    pipeline.process(&inL[pos], &inR[pos], &outL[pos], &outR[pos], n, events);
+    pos += size_t(n);
+    // A host call's worth of time, so every block is back when due.
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  pipeline.finish();
+  shm.detachWorker();
+  worker.join();
+
+  const size_t latency = pipeline.latency();
+  int wrong = 0;
+  for (size_t i = 0; i < total; ++i) {
+    const float wantL = i < latency ? 0.0f : inL[i - latency] * kGain;
+    const float wantR = i < latency ? 0.0f : inR[i - latency] * kGain;
+    if (outL[i] == wantL && outR[i] == wantR) continue;
+    if (wrong++ == 0) {
+      fprintf(stderr, "%s: frame %zu is %g, expected %g\n", name, i, double(outL[i]), double(wantL));
+    }
+  }
+  printf("%-10s %zu frames, latency %zu, %llu missed blocks, %d wrong frames\n", name, total,
+         latency, static_cast<unsigned long long>(pipeline.misses()), wrong);
+  return wrong + int(pipeline.misses());
+}
+
+}  // namespace
+
+int main() {
+  int failures = 0;
+  failures += run("full", std::vector<int>(16, int(kMaxBlock)));
+  failures += run("shrinking", {512, 200, 512, 512, 512, 512, 200, 200, 512, 512});
+
+  std::vector<int> sizes;
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> size(1, int(kMaxBlock));
+  for (int i = 0; i < 400; ++i) sizes.push_back(size(rng));
+  failures += run("random", sizes);
+
+  sizes.clear();
+  for (int i = 0; i < 64; ++i) sizes.push_back(i % 3 == 0 ? 1 : i % 3 == 1 ? 511 : 64);
+  failures += run("uneven", sizes);
+
+  if (failures != 0) {
+    fprintf(stderr, "FAILED\n");
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
@@ -0,0 +1,154 @@
+import 'dart:typed_data';
+import 'package:test/test.dart';
+import 'package:flutter_vst3/flutter_vst3.dart';
+
+const _cmdProcess = 0x02;
+const _parameter = 0;
+const _noteOn = 1;
+const _noteOff = 2;
+
+/// An event record as packed by the native side (DartVst3IpcEvent).
+class _Event {
+  final int offset, type, id, channel;
+  final double value;
+  const _Event(this.offset, this.type, this.id, this.channel, this.value);
+}
+
+/// Packs a pipe CMD_PROCESS request whose left plane counts up from 0 and
+/// right plane down from -1.
+Uint8List _request(int frames, List<_Event> events) {
+  final audioStart =
+      dartVst3PipeRequestHeaderSize + events.length * dartVst3EventSize;
+  final bytes = Uint8List(audioStart + frames * 8);
+  final data = ByteData.sublistView(bytes);
+  data.setUint8(0, _cmdProcess);
+  data.setInt32(4, frames, Endian.host);
+  data.setInt32(8, events.length, Endian.host);
+  for (var i = 0; i < events.length; i++) {
+    final at = dartVst3PipeRequestHeaderSize + i * dartVst3EventSize;
+    final e = events[i];
+    data.setUint32(at, e.offset, Endian.host);
+    data.setUint32(at + 4, e.type, Endian.host);
+    data.setInt32(at + 8, e.id, Endian.host);
+    data.setInt32(at + 12, e.channel, Endian.host);
+    data.setFloat64(at + 16, e.value, Endian.host);
+  }
+  final audio = bytes.buffer.asFloat32List(audioStart, frames * 2);
+  for (var i = 0; i < frames; i++) {
+    audio[i] = i.toDouble();
+    audio[frames + i] = -1.0 - i;
+  }
+  return bytes;
+}
+
+/// Doubles its input and logs every call with the frame it lands on.
+SharedAudioHandler _recorder(List<String> log, {bool notes = true}) {
+  var frame = 0;
+  return SharedAudioHandler(
+    process: (inL, inR, outL, outR) {
+      log.add('process ${inL.length}');
+      for (var i = 0; i < inL.length; i++) {
+        outL[i] = inL[i] * 2;
+        outR[i] = inR[i] * 2;
+      }
+      frame += inL.length;
+    },
+    setParameter: (id, value) => log.add('parameter $id $value @$frame'),
+    noteOn: notes
+        ? (channel, pitch, velocity) =>
+            log.add('noteOn $channel $pitch $velocity @$frame')
+        : null,
+    noteOff: notes
+        ? (channel, pitch, velocity) =>
+            log.add('noteOff $channel $pitch $velocity @$frame')
+        : null,
+  );
+}
+
+void main() {
+  test('pipe blocks split at each event and reply with planar audio', () {
+    final log = <String>[];
+    final request = _request(16, const [
+      _Event(0, _parameter, 3, 0, 0.25), // first frame
+      _Event(5, _noteOn, 60, 1, 0.5), // mid-block
+      _Event(15, _noteOff, 60, 1, 0.0), // last frame
+      _Event(40, _parameter, 4, 0, 0.75), // past the end
+    ]);
+
+    final reply = processPipeBlock(_recorder(log), ByteData.sublistView(request));
+
+    expect(log, [
+      'parameter 3 0.25 @0',
+      'process 5',
+      'noteOn 1 60 0.5 @5',
+      'process 10',
+      'noteOff 1 60 0.0 @15',
+      'process 1',
+      'parameter 4 0.75 @16',
+    ]);
+    expect(reply.length, dartVst3PipeReplyHeaderSize + 16 * 8);
+    expect(reply[0], _cmdProcess);
+    final output = reply.buffer.asFloat32List(dartVst3PipeReplyHeaderSize, 32);
+    for (var i = 0; i < 16; i++) {
+      expect(output[i], 2.0 * i);
+      expect(output[16 + i], -2.0 - 2 * i);
+    }
+  });
+
+  test('blocks without events render in one call on the given lists', () {
+    final inL = Float32List.fromList([1, 2, 3]);
+    final inR = Float32List.fromList([4, 5, 6]);
+    final outL = Float32List(3);
+    final outR = Float32List(3);
+    final seen = <Float32List>[];
+    processBlock(
+        SharedAudioHandler(
+            process: (a, b, c, d) => seen.addAll([a, b, c, d]),
+            setParameter: (_, __) {}),
+        ByteData(0),
+        0,
+        inL,
+        inR,
+        outL,
+        outR);
+    expect(seen.length, 4);
+    expect(identical(seen[0], inL) && identical(seen[3], outR), isTrue);
+  });
+
+  test('notes are dropped when the handler takes none', () {
+    final log = <String>[];
+    final request = _request(8, const [
+      _Event(2, _noteOn, 64, 0, 1.0),
+      _Event(4, _parameter, 1, 0, 0.5),
+    ]);
+    processPipeBlock(
+        _recorder(log, notes: false), ByteData.sublistView(request));
+    expect(log, ['process 2', 'process 2', 'parameter 1 0.5 @4', 'process 4']);
+  });
+
+  test('pipe messages are reassembled from arbitrary chunks', () {
+    final init = Uint8List(9)..[0] = 0x01;
+    final process = _request(512, [
+      for (var i = 0; i < 256; i++) _Event(i * 2, _parameter, i, 0, i / 256)
+    ]);
+    final stream = [...init, ...process, ...process, 0xFF];
+
+    for (final chunk in [1, 7, 4096, stream.length]) {
+      final reader = PipeMessageReader();
+      final messages = <Uint8List>[];
+      for (var at = 0; at < stream.length; at += chunk) {
+        final end = at + chunk < stream.length ? at + chunk : stream.length;
+        reader.add(stream.sublist(at, end));
+        for (var m = reader.next(); m != null; m = reader.next()) {
+          expect(m.offsetInBytes % 4, 0);
+          messages.add(Uint8List.fromList(Uint8List.sublistView(m)));
+        }
+      }
+      expect(messages.map((m) => m.length).toList(),
+          [9, process.length, process.length, 1], reason: 'chunk $chunk');
+      expect(messages[1], process);
+      expect(messages[2], process);
+      expect(messages[3], [0xFF]);
+    }
+  });
+}
@@ -1,16 +1,15 @@
 import 'dart:io';
 import 'dart:typed_data';
+import 'package:flutter_vst3/flutter_vst3.dart';
 import 'src/echo_processor.dart';
 import 'src/echo_parameters.dart';
 
 const CMD_INIT = 0x01;
 const CMD_PROCESS = 0x02;
-const CMD_SET_PARAM = 0x03;
 const CMD_TERMINATE = 0xFF;
 
-void main() async {
-  final processor = EchoProcessor();
-  final parameters = EchoParameters();
+void main(List<String> args) async {
+  late SharedAudioHandler handler;
   
   // CRITICAL: Set binary mode (only if stdin is a terminal)
   try {
@@ -19,63 +18,48 @@ void main() async {
     // Ignore error if stdin is not a terminal (e.g., when piped)
   }
   
-  // Main event loop
+  // Audio arrives through shared memory when the host maps a region
+  if (await serveSharedAudio(args, _createHandler)) return;
+  
+  // Main event loop. Requests can arrive split across reads or several
+  // to a read, so they are reassembled from their headers first.
+  final messages = PipeMessageReader();
   await for (final bytes in stdin) {
-    if (bytes.isEmpty) continue;
-    
-    final buffer = ByteData.view(Uint8List.fromList(bytes).buffer);
-    final command = buffer.getUint8(0);
-    
-    switch (command) {
-      case CMD_INIT:
-        final sampleRate = buffer.getFloat64(1, Endian.little);
-        processor.initialize(sampleRate, 512);
-        stdout.add([CMD_INIT]); // ACK
-        await stdout.flush();
-        break;
-        
-      case CMD_PROCESS:
-        final numSamples = buffer.getInt32(1, Endian.little);
-        // Read interleaved stereo
-        final audioData = Float32List(numSamples * 2);
-        for (int i = 0; i < numSamples * 2; i++) {
-          audioData[i] = buffer.getFloat32(5 + i * 4, Endian.little);
-        }
-        
-        // Split to L/R
-        final inputL = List<double>.generate(numSamples, 
-            (i) => audioData[i * 2].toDouble());
-        final inputR = List<double>.generate(numSamples, 
-            (i) => audioData[i * 2 + 1].toDouble());
-        
-        final outputL = List<double>.filled(numSamples, 0.0);
-        final outputR = List<double>.filled(numSamples, 0.0);
-        
-        // PROCESS WITH YOUR DART CODE!
-        processor.processStereo(inputL, inputR, outputL, outputR, parameters);
-        
-        // Send back interleaved
-        final response = ByteData(1 + numSamples * 8);
-        response.setUint8(0, CMD_PROCESS);
-        for (int i = 0; i < numSamples; i++) {
-          response.setFloat32(1 + i * 8, outputL[i], Endian.little);
-          response.setFloat32(1 + i * 8 + 4, outputR[i], Endian.little);
-        }
-        
-        stdout.add(response.buffer.asUint8List());
-        await stdout.flush();
-        break;
-        
-      case CMD_SET_PARAM:
-        final paramId = buffer.getInt32(1, Endian.little);
-        final value = buffer.getFloat64(5, Endian.little);
-        parameters.setParameter(paramId, value);
-        stdout.add([CMD_SET_PARAM]); // ACK
-        await stdout.flush();
-        break;
-        
-      case CMD_TERMINATE:
-        exit(0);
+    messages.add(bytes);
+    for (var buffer = messages.next(); buffer != null; buffer = messages.next()) {
+      final command = buffer.getUint8(0);
+      
+      switch (command) {
+        case CMD_INIT:
+          final sampleRate = buffer.getFloat64(1, Endian.little);
+          handler = _createHandler(sampleRate, 512);
+          stdout.add([CMD_INIT]); // ACK
+          await stdout.flush();
+          break;
+          
+        case CMD_PROCESS:
+          // PROCESS WITH YOUR DART CODE, applying each event at its frame!
+          // The planar audio is processed where the reader buffered it and
+          // rendered straight into the reply.
+          stdout.add(processPipeBlock(handler, buffer));
+          await stdout.flush();
+          break;
+          
+        case CMD_TERMINATE:
+          exit(0);
+      }
     }
   }
-}
\ No newline at end of file
+}
+
+/// Builds the block handler, on the shared-memory worker isolate or for
+/// the pipe loop.
+SharedAudioHandler _createHandler(double sampleRate, int maxBlock) {
+  final processor = EchoProcessor()..initialize(sampleRate, maxBlock);
+  final parameters = EchoParameters();
+  return SharedAudioHandler(
+    process: (inL, inR, outL, outR) =>
+        processor.processStereo(inL, inR, outL, outR, parameters),
+    setParameter: parameters.setParameter,
+  );
+}